@@ -167,7 +167,7 @@ void Application::_exit()
     {
         auto reply = mainWindow_->checkModifiedEntries();
         if( reply == AskForSaveDialog::Cancel ) return;
-        else if( reply == AskForSaveDialog::Yes ) mainWindow_->saveUnchecked();
+        else if( reply == AskForSaveDialog::Yes ) mainWindow_->saveUnchecked( true );
         else if( mainWindow_->logbookIsModified() && mainWindow_->askForSave() == AskForSaveDialog::Cancel ) return;
     }
 
@@ -23,8 +23,10 @@
 #include "Debug.h"
 #include "File.h"
 #include "LogEntry.h"
+#include "Snapshot.h"
 #include "XmlDef.h"
 #include "XmlOptions.h"
+#include "XmlStreamUtil.h"
 #include "XmlTimeStamp.h"
 
 #include <QRegularExpression>
@@ -79,6 +81,73 @@ Attachment::Attachment( const QDomElement& element):
 
 }
 
+//_______________________________________
+Attachment::Attachment( QXmlStreamReader& reader ):
+    Counter( QStringLiteral("Attachment") )
+{
+    Debug::Throw() << "Attachment::Attachment.\n";
+
+    // parse attributes
+    for( const auto& attribute:reader.attributes() )
+    {
+        const auto name( attribute.name() );
+        const auto value( attribute.value().toString() );
+
+        if( name == Xml::SourceFile ) _setSourceFile( File( value ) );
+        else if( name == Xml::File ) _setFile( File( value ) );
+        else if( name == Xml::Type ) setIsUrl( value == QLatin1String("URL") );
+        else if( name == Xml::Comments ) setComments( value );
+        else if( name == Xml::Valid ) setIsValid( (bool) value.toInt() );
+        else if( name == Xml::IsLink ) setIsLink( (LinkState) value.toInt() );
+        else if( name == Xml::IsUrl ) setIsUrl( (bool) value.toInt() );
+    }
+
+    // parse children elements
+    QDomDocument document;
+    while( reader.readNextStartElement() )
+    {
+        const auto tagName( reader.name() );
+        if( tagName == Xml::Comments ) setComments( reader.readElementText( QXmlStreamReader::IncludeChildElements ) );
+        else if( tagName == Xml::Creation ) _setCreation( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == Xml::Modification ) _setModification( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else reader.skipCurrentElement();
+    }
+
+    // by default all URL attachments are valid, provided that the SOURCE_FILE is not empty
+    if( isUrl_ && !sourceFile_.isEmpty() ) setIsValid( true );
+
+}
+
+//_______________________________________
+Attachment::Attachment( QDataStream& stream ):
+    Counter( QStringLiteral("Attachment") )
+{
+    Debug::Throw() << "Attachment::Attachment.\n";
+
+    QString sourceFile;
+    QString file;
+    QString comments;
+    bool isValid( false );
+    qint32 isLink( 0 );
+    bool isUrl( false );
+    stream >> sourceFile >> file >> comments >> isValid >> isLink >> isUrl;
+
+    // empty values are skipped, consistently with xml
+    if( !sourceFile.isEmpty() ) _setSourceFile( File( sourceFile ) );
+    if( !file.isEmpty() ) _setFile( File( file ) );
+    if( !comments.isEmpty() ) setComments( comments );
+    setIsValid( isValid );
+    setIsLink( (LinkState) isLink );
+    setIsUrl( isUrl );
+
+    _setCreation( Snapshot::readTimeStamp( stream ) );
+    _setModification( Snapshot::readTimeStamp( stream ) );
+
+    // by default all URL attachments are valid, provided that the SOURCE_FILE is not empty
+    if( isUrl_ && !sourceFile_.isEmpty() ) setIsValid( true );
+
+}
+
 //____________________________________________________
 QDomElement Attachment::domElement( QDomDocument& parent ) const
 {
@@ -105,6 +174,46 @@ QDomElement Attachment::domElement( QDomDocument& parent ) const
 
 }
 
+//____________________________________________________
+void Attachment::writeXml( QXmlStreamWriter& writer ) const
+{
+
+    Debug::Throw( QStringLiteral("Attachment::writeXml.\n") );
+    writer.writeStartElement( Xml::Attachment );
+    if( !file_.isEmpty() ) writer.writeAttribute( Xml::File, file_.get() );
+    if( !sourceFile_.isEmpty() ) writer.writeAttribute( Xml::SourceFile, sourceFile_.get() );
+    writer.writeAttribute( Xml::Valid, QString::number( isValid() ) );
+    writer.writeAttribute( Xml::IsLink, QString::number( Base::toIntegralType( isLink() ) ) );
+    writer.writeAttribute( Xml::IsUrl, QString::number( isUrl() ) );
+    if( comments().size() ) writer.writeTextElement( Xml::Comments, comments() );
+
+    // dump timeStamp
+    QDomDocument document;
+    if( creation_.isValid() ) XmlStreamUtil::writeElement( writer, XmlTimeStamp( creation() ).domElement( Xml::Creation, document ) );
+    if( modification_.isValid() ) XmlStreamUtil::writeElement( writer, XmlTimeStamp( modification() ).domElement( Xml::Modification, document ) );
+
+    writer.writeEndElement();
+
+}
+
+//____________________________________________________
+void Attachment::writeSnapshot( QDataStream& stream ) const
+{
+
+    Debug::Throw( QStringLiteral("Attachment::writeSnapshot.\n") );
+    stream
+        << sourceFile_.get()
+        << file_.get()
+        << comments_
+        << isValid_
+        << qint32( Base::toIntegralType( isLink_ ) )
+        << isUrl_;
+
+    Snapshot::writeTimeStamp( stream, creation_ );
+    Snapshot::writeTimeStamp( stream, modification_ );
+
+}
+
 //___________________________________
 bool operator < ( const Attachment& first, const Attachment& second)
 { return first.shortFile().get().compare( second.shortFile(), XmlOptions::get().get<bool>( QStringLiteral("CASE_SENSITIVE") ) ? Qt::CaseSensitive:Qt::CaseInsensitive ) < 0; }
@@ -26,8 +26,11 @@
 #include "Key.h"
 #include "TimeStamp.h"
 
+#include <QDataStream>
 #include <QDomDocument>
 #include <QDomElement>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 class LogEntry;
 
@@ -55,9 +58,21 @@ class Attachment: private Base::Counter<Attachment>, public Base::Key
     //* creator from DomElement
     explicit Attachment( const QDomElement& element );
 
+    //* creator from xml stream
+    explicit Attachment( QXmlStreamReader& );
+
+    //* creator from binary snapshot
+    explicit Attachment( QDataStream& );
+
     //* domElement
     QDomElement domElement( QDomDocument& parent ) const;
 
+    //* write to xml stream
+    void writeXml( QXmlStreamWriter& ) const;
+
+    //* write to binary snapshot
+    void writeSnapshot( QDataStream& ) const;
+
     //*@name accessors
     //@{
 
@@ -256,6 +256,7 @@ void AttachmentFrame::_new()
 
             // associate attachment to entry
             Base::Key::associate( entry, attachment );
+            entry->setDirty( true );
 
             // update all windows edition windows associated to entry
             windows = Base::KeySet<EditionWindow>( entry );
@@ -867,6 +868,9 @@ void AttachmentFrame::_saveAttachments( const AttachmentModel::List& attachments
     for( const auto& entry:entries )
     {
 
+        // mark entry as modified, for it to be saved
+        entry->setDirty( true );
+
         // get associated logbooks and store
         logbooks.unite( Base::KeySet<Logbook>( entry ) );
 
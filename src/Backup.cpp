@@ -39,6 +39,23 @@ Backup::Backup( const QDomElement& element ):
     }
 }
 
+//______________________________________________________________________
+Backup::Backup( QXmlStreamReader& reader ):
+    Counter( QStringLiteral("Backup") ),
+    valid_( true )
+{
+    Debug::Throw( QStringLiteral("Backup::Backup.\n") );
+
+    // parse attributes
+    for( const auto& attribute:reader.attributes() )
+    {
+        if( attribute.name() == Xml::Creation ) setCreation( TimeStamp(attribute.value().toInt()) );
+        else if( attribute.name() == Xml::File ) setFile( File( attribute.value().toString() ) );
+    }
+
+    reader.skipCurrentElement();
+}
+
 //______________________________________________________________________
 QDomElement Backup::domElement( QDomDocument& document ) const
 {
@@ -48,3 +65,12 @@ QDomElement Backup::domElement( QDomDocument& document ) const
     out.setAttribute( Xml::File, file() );
     return out;
 }
+
+//______________________________________________________________________
+void Backup::writeXml( QXmlStreamWriter& writer ) const
+{
+    Debug::Throw( QStringLiteral("Backup::writeXml.\n") );
+    writer.writeEmptyElement( Xml::BackupMask );
+    writer.writeAttribute( Xml::Creation, QString::number( creation_.unixTime() ) );
+    writer.writeAttribute( Xml::File, file_.get() );
+}
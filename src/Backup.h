@@ -29,6 +29,8 @@
 #include <QDomDocument>
 #include <QDomElement>
 #include <QVector>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 //* store backup information
 class Backup final: private Base::Counter<Backup>
@@ -50,12 +52,18 @@ class Backup final: private Base::Counter<Backup>
     //* constructor from Dom
     explicit Backup( const QDomElement& );
 
+    //* constructor from xml stream
+    explicit Backup( QXmlStreamReader& );
+
     //*@name accessors
     //@{
 
     //* get dom
     QDomElement domElement( QDomDocument& ) const;
 
+    //* write to xml stream
+    void writeXml( QXmlStreamWriter& ) const;
+
     //* creation
     const TimeStamp& creation() const
     { return creation_; }
@@ -0,0 +1,242 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "BodyStore.h"
+#include "Debug.h"
+#include "LogEntry.h"
+
+#include <algorithm>
+
+//________________________________________________________
+BodyStore& BodyStore::get()
+{
+    static BodyStore singleton;
+    return singleton;
+}
+
+//________________________________________________________
+bool BodyStore::write( const LogEntry* entry, const QByteArray& data )
+{
+
+    release( entry );
+    if( !_open() ) return false;
+
+    // append
+    if( !file_->seek( size_ ) || file_->write( data ) != data.size() )
+    {
+        Debug::Throw(0) << "BodyStore::write - unable to write to " << file_->fileName() << Qt::endl;
+        return false;
+    }
+
+    Locator locator;
+    locator.offset = size_;
+    locator.size = data.size();
+    locators_.insert( entry, locator );
+    size_ += data.size();
+    return true;
+
+}
+
+//________________________________________________________
+QByteArray BodyStore::read( const LogEntry* entry )
+{
+
+    const auto iter( locators_.constFind( entry ) );
+    if( iter == locators_.constEnd() || !file_ ) return QByteArray();
+    if( !file_->seek( iter->offset ) )
+    {
+        Debug::Throw(0) << "BodyStore::read - unable to read from " << file_->fileName() << Qt::endl;
+        return QByteArray();
+    }
+
+    return file_->read( iter->size );
+
+}
+
+//________________________________________________________
+void BodyStore::release( const LogEntry* entry )
+{
+
+    const auto iter( locators_.find( entry ) );
+    if( iter == locators_.end() ) return;
+
+    releasedSize_ += iter->size;
+    locators_.erase( iter );
+    _compact();
+
+}
+
+//________________________________________________________
+void BodyStore::setBudget( qint64 value )
+{
+    if( budget_ == value ) return;
+    budget_ = value;
+
+    // stop tracking bodies when there is no limit
+    if( !budget_ )
+    {
+        entries_.clear();
+        nodes_.clear();
+        statistics_.count = 0;
+        statistics_.size = 0;
+    }
+
+    _evict();
+}
+
+//________________________________________________________
+void BodyStore::touch( const LogEntry* entry, qint64 size, Access access )
+{
+
+    switch( access )
+    {
+        case Access::Hit: ++statistics_.hits; break;
+        case Access::Miss: ++statistics_.misses; break;
+        default: break;
+    }
+
+    // no need to track bodies when there is no limit
+    if( !budget_ ) return;
+
+    auto iter( nodes_.find( entry ) );
+    if( iter == nodes_.end() )
+    {
+
+        entries_.push_front( entry );
+        Node node;
+        node.iterator = entries_.begin();
+        node.size = size;
+        nodes_.insert( entry, node );
+        ++statistics_.count;
+
+    } else {
+
+        // move to front and update size
+        entries_.splice( entries_.begin(), entries_, iter->iterator );
+        statistics_.size -= iter->size;
+        iter->size = size;
+
+    }
+
+    statistics_.size += size;
+    _evict();
+
+}
+
+//________________________________________________________
+void BodyStore::remove( const LogEntry* entry )
+{
+
+    const auto iter( nodes_.find( entry ) );
+    if( iter == nodes_.end() ) return;
+
+    entries_.erase( iter->iterator );
+    statistics_.size -= iter->size;
+    --statistics_.count;
+    nodes_.erase( iter );
+
+}
+
+//________________________________________________________
+void BodyStore::_evict()
+{
+
+    /*
+    the most recently used body is never evicted,
+    since references to its text might still be in use by the caller.
+    This does not protect references to other entries text and formats,
+    which must be copied before accessing another entry body
+    */
+    while( budget_ && statistics_.size > budget_ && entries_.size() > 1 )
+    {
+        // unloading the entry body also removes it from the list
+        const auto entry( entries_.back() );
+        if( !entry->unloadBody() ) break;
+        ++statistics_.evictions;
+    }
+
+}
+
+//________________________________________________________
+bool BodyStore::_open()
+{
+
+    if( file_ ) return true;
+    std::unique_ptr<QTemporaryFile> file( new QTemporaryFile );
+    if( !file->open() )
+    {
+        Debug::Throw(0) << "BodyStore::_open - unable to create temporary file: " << file->errorString() << Qt::endl;
+        return false;
+    }
+
+    file_ = std::move( file );
+    size_ = 0;
+    releasedSize_ = 0;
+    return true;
+
+}
+
+//________________________________________________________
+void BodyStore::_compact()
+{
+
+    if( !( releasedSize_ >= MinReleasedSize && 2*releasedSize_ >= size_ ) ) return;
+    Debug::Throw() << "BodyStore::_compact - reclaiming " << releasedSize_ << " bytes out of " << size_ << Qt::endl;
+
+    std::unique_ptr<QTemporaryFile> file( new QTemporaryFile );
+    if( !file->open() )
+    {
+        Debug::Throw(0) << "BodyStore::_compact - unable to create temporary file: " << file->errorString() << Qt::endl;
+        return;
+    }
+
+    // copy live bodies, in file order. Locators are only updated once all are copied, so that the current file stays valid on error
+    QList<const LogEntry*> entries( locators_.keys() );
+    std::sort( entries.begin(), entries.end(), [this]( const LogEntry* first, const LogEntry* second )
+        { return locators_[first].offset < locators_[second].offset; } );
+
+    QHash<const LogEntry*, Locator> locators;
+    locators.reserve( locators_.size() );
+    qint64 size( 0 );
+    for( const auto& entry:entries )
+    {
+        const auto& locator( locators_[entry] );
+        QByteArray data;
+        if( file_->seek( locator.offset ) ) data = file_->read( locator.size );
+        if( data.size() != locator.size || file->write( data ) != data.size() )
+        {
+            Debug::Throw(0) << "BodyStore::_compact - unable to copy stored bodies." << Qt::endl;
+            return;
+        }
+
+        Locator newLocator;
+        newLocator.offset = size;
+        newLocator.size = locator.size;
+        locators.insert( entry, newLocator );
+        size += locator.size;
+    }
+
+    // the previous file is removed when closed
+    file_ = std::move( file );
+    locators_ = std::move( locators );
+    size_ = size;
+    releasedSize_ = 0;
+    ++statistics_.compactions;
+
+}
@@ -0,0 +1,191 @@
+#ifndef BodyStore_h
+#define BodyStore_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <QByteArray>
+#include <QHash>
+#include <QTemporaryFile>
+
+#include <list>
+#include <memory>
+
+class LogEntry;
+
+/**
+\class BodyStore
+\brief on-disk storage for log entry bodies that are not kept in memory.
+Bodies are appended to a temporary file, removed at exit, and located by their offset and size, for each entry.
+Space used by bodies that are released, because their entry is modified or deleted, is reclaimed
+by rewriting the live bodies to a new file, once it exceeds both a fixed size and half of the file size.
+It also keeps track of the bodies that are in memory, in least recently used order,
+and moves the coldest ones to the store when their total size exceeds a configurable budget.
+It must only be used from the main thread.
+*/
+class BodyStore final
+{
+
+    public:
+
+    //* singleton
+    static BodyStore& get();
+
+    //* store entry body, replacing any previously stored one. Returns false on error
+    bool write( const LogEntry*, const QByteArray& );
+
+    //* read entry body. Returns an empty array if none is stored
+    QByteArray read( const LogEntry* );
+
+    //* release stored entry body, when the entry is modified or deleted
+    void release( const LogEntry* );
+
+    //*@name memory budget
+    //@{
+
+    //* body access type
+    enum class Access
+    {
+        //* body accessed while in memory
+        Hit,
+
+        //* body loaded from store
+        Miss,
+
+        //* body modified
+        Update
+    };
+
+    //* statistics
+    class Statistics
+    {
+
+        public:
+
+        //* number of accesses to bodies in memory
+        qint64 hits = 0;
+
+        //* number of bodies loaded from store
+        qint64 misses = 0;
+
+        //* number of bodies moved to store to match budget
+        qint64 evictions = 0;
+
+        //* number of tracked bodies in memory
+        int count = 0;
+
+        //* total size of tracked bodies in memory
+        qint64 size = 0;
+
+        //* number of times the store file was rewritten to reclaim released bodies
+        int compactions = 0;
+
+    };
+
+    //* statistics
+    const Statistics& statistics() const
+    { return statistics_; }
+
+    //* memory budget, in bytes. Zero means no limit
+    qint64 budget() const
+    { return budget_; }
+
+    //* set memory budget, in bytes. Zero means no limit
+    void setBudget( qint64 );
+
+    //* register access to an entry body in memory, with its size. Cold bodies are evicted if budget is exceeded
+    void touch( const LogEntry*, qint64 size, Access );
+
+    //* unregister entry, when its body is moved to store or the entry is deleted
+    void remove( const LogEntry* );
+
+    //@}
+
+    private:
+
+    //* evict least recently used bodies until budget is matched
+    void _evict();
+
+    //* constructor
+    explicit BodyStore() = default;
+
+    //* open file if needed. Returns true on success
+    bool _open();
+
+    //* rewrite live bodies to a new file, if enough space is used by released ones
+    void _compact();
+
+    //* location of stored data
+    class Locator
+    {
+
+        public:
+
+        //* offset in file
+        qint64 offset = 0;
+
+        //* size
+        int size = 0;
+
+    };
+
+    //* minimum size of released bodies for the file to be compacted
+    static const qint64 MinReleasedSize = 16<<20;
+
+    //* file
+    std::unique_ptr<QTemporaryFile> file_;
+
+    //* current file size
+    qint64 size_ = 0;
+
+    //* size of released bodies, still in file
+    qint64 releasedSize_ = 0;
+
+    //* location of stored bodies, for each entry
+    QHash<const LogEntry*, Locator> locators_;
+
+    //* memory budget
+    qint64 budget_ = 0;
+
+    //* statistics
+    Statistics statistics_;
+
+    //* entries with body in memory, most recently used first
+    using EntryList = std::list<const LogEntry*>;
+    EntryList entries_;
+
+    //* position in list and body size, for each entry
+    class Node
+    {
+        public:
+
+        //* position in list
+        EntryList::iterator iterator;
+
+        //* body size
+        qint64 size = 0;
+
+    };
+
+    //* nodes
+    QHash<const LogEntry*, Node> nodes_;
+
+};
+
+#endif
@@ -102,6 +102,70 @@ ConfigurationDialog::ConfigurationDialog( QWidget* parent ):
         gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Compress logbook files" ), page, QStringLiteral("USE_COMPRESSION") ), row++, 0, 1, 2 );
         addOptionWidget( checkbox );
 
+        gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Write logbook files in parallel" ), page, QStringLiteral("PARALLEL_WRITE") ), row++, 0, 1, 2 );
+        checkbox->setToolTip( tr( "Compress and write modified logbook files concurrently when saving. This uses more memory, since file contents are prepared in memory rather than streamed to disk" ) );
+        addOptionWidget( checkbox );
+
+        gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Keep binary snapshots of logbook files" ), page, QStringLiteral("USE_SNAPSHOT") ), row++, 0, 1, 2 );
+        checkbox->setToolTip( tr( "Store a binary copy of each logbook file next to it, to speed-up loading" ) );
+        addOptionWidget( checkbox );
+
+        gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Load entries text on demand" ), page, QStringLiteral("LAZY_LOADING") ), row++, 0, 1, 2 );
+        checkbox->setToolTip( tr( "Keep entries text in a temporary file until it is displayed, searched or printed, to reduce memory usage" ) );
+        addOptionWidget( checkbox );
+
+        gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Journal entry changes" ), page, QStringLiteral("USE_JOURNAL") ), row++, 0, 1, 2 );
+        checkbox->setToolTip( tr( "Append entry changes to a journal next to the logbook file when saving.\nLogbook files are written on autosave, when closing, or when the journal gets too large" ) );
+        addOptionWidget( checkbox );
+
+        gridLayout->addWidget( new QLabel( tr( "Entries text memory budget:" ), page ), row, 0, 1, 1 );
+        gridLayout->addWidget( spinbox = new OptionSpinBox( page, QStringLiteral("TEXT_MEMORY_BUDGET") ), row++, 1, 1, 1 );
+        spinbox->setToolTip( tr( "Maximum memory used by entries text. Least recently used text is moved to a temporary file when exceeded" ) );
+        spinbox->setSuffix( tr( " MB" ) );
+        spinbox->setSpecialValueText( tr( "Unlimited" ) );
+        spinbox->setMinimum( 0 );
+        spinbox->setMaximum( 65536 );
+        addOptionWidget( spinbox );
+
+        gridLayout->addWidget( new QLabel( tr( "Maximum number of entries per file:" ), page ), row, 0, 1, 1 );
+        gridLayout->addWidget( spinbox = new OptionSpinBox( page, QStringLiteral("SHARD_MAX_ENTRIES") ), row++, 1, 1, 1 );
+        spinbox->setToolTip( tr( "New entries are added to a new logbook file when this number is reached.\nUse Reorganize to redistribute existing entries" ) );
+        spinbox->setSpecialValueText( tr( "Unlimited" ) );
+        spinbox->setMinimum( 0 );
+        spinbox->setMaximum( 100000 );
+        addOptionWidget( spinbox );
+        auto maxEntriesSpinBox( spinbox );
+
+        gridLayout->addWidget( new QLabel( tr( "Maximum size of entries per file:" ), page ), row, 0, 1, 1 );
+        gridLayout->addWidget( spinbox = new OptionSpinBox( page, QStringLiteral("SHARD_MAX_SIZE") ), row++, 1, 1, 1 );
+        spinbox->setToolTip( tr( "New entries are added to a new logbook file when the size of its entries reaches this value.\nUse Reorganize to redistribute existing entries" ) );
+        spinbox->setSuffix( tr( " kB" ) );
+        spinbox->setSpecialValueText( tr( "Unlimited" ) );
+        spinbox->setMinimum( 0 );
+        spinbox->setMaximum( 1048576 );
+        addOptionWidget( spinbox );
+
+        gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Store entries in one file per month" ), page, QStringLiteral("SHARD_BY_MONTH") ), row++, 0, 1, 2 );
+        checkbox->setToolTip( tr( "Add entries to the logbook file matching their creation month, regardless of number and size.\nUse Reorganize to redistribute existing entries" ) );
+        addOptionWidget( checkbox );
+
+        checkbox->setChecked( false );
+        connect( checkbox, &QAbstractButton::toggled, maxEntriesSpinBox, &QWidget::setDisabled );
+        connect( checkbox, &QAbstractButton::toggled, spinbox, &QWidget::setDisabled );
+
+        gridLayout->addWidget( new QLabel( tr( "Only load entries created during the last:" ), page ), row, 0, 1, 1 );
+        gridLayout->addWidget( spinbox = new OptionSpinBox( page, QStringLiteral("LOADED_MONTHS") ), row++, 1, 1, 1 );
+        spinbox->setToolTip( tr( "Logbook files holding older entries are loaded on demand, when scrolling, searching or selecting their keywords.\nIt takes effect when a logbook is opened" ) );
+        spinbox->setSuffix( tr( " months" ) );
+        spinbox->setSpecialValueText( tr( "All" ) );
+        spinbox->setMinimum( 0 );
+        spinbox->setMaximum( 1200 );
+        addOptionWidget( spinbox );
+
+        gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Exchange entry changes with other running instances" ), page, QStringLiteral("LIVE_SYNC") ), row++, 0, 1, 2 );
+        checkbox->setToolTip( tr( "Send entries to another running instance when saving, and merge entries received from it" ) );
+        addOptionWidget( checkbox );
+
         gridLayout->addWidget( checkbox = new OptionCheckBox( tr( "Make backup of files when saving modifications" ), page, QStringLiteral("FILE_BACKUP") ), row++, 0, 1, 2 );
         checkbox->setToolTip( tr( "Make backup of the file prior to saving modifications" ) );
         addOptionWidget( checkbox );
@@ -24,6 +24,7 @@
 #include "Color.h"
 #include "CppUtil.h"
 #include "File.h"
+#include "FileFormat.h"
 #include "LogEntry.h"
 #include "LogEntryModel.h"
 #include "LogEntryPrintSelectionWidget.h"
@@ -85,6 +86,18 @@ void installDefaultOptions()
     XmlOptions::get().set<int>( QStringLiteral("ATTACHMENT_LIST_ICON_SIZE"), 22 );
 
     XmlOptions::get().set<bool>( QStringLiteral("USE_COMPRESSION"), true );
+    XmlOptions::get().set<bool>( QStringLiteral("PARALLEL_WRITE"), true );
+    XmlOptions::get().set<bool>( QStringLiteral("USE_SNAPSHOT"), false );
+    XmlOptions::get().set<bool>( QStringLiteral("LAZY_LOADING"), false );
+    XmlOptions::get().set<bool>( QStringLiteral("USE_JOURNAL"), false );
+    XmlOptions::get().set<int>( QStringLiteral("SHARD_MAX_ENTRIES"), Logbook::MaxEntries );
+    XmlOptions::get().set<int>( QStringLiteral("SHARD_MAX_SIZE"), 0 );
+    XmlOptions::get().set<bool>( QStringLiteral("SHARD_BY_MONTH"), false );
+    XmlOptions::get().set<int>( QStringLiteral("LOADED_MONTHS"), 0 );
+    XmlOptions::get().set<bool>( QStringLiteral("LIVE_SYNC"), false );
+    XmlOptions::get().set( QStringLiteral("LIVE_SYNC_CHANNEL"), Option( QStringLiteral("elogbook-sync-%1").arg( Util::user() ) ) );
+    XmlOptions::get().set<int>( QStringLiteral("TEXT_MEMORY_BUDGET"), 0 );
+    XmlOptions::get().set( QStringLiteral("COMPRESSION_CODEC"), Option( FileFormat::name( FileFormat::defaultCodec() ) ) );
     XmlOptions::get().set<bool>( QStringLiteral("FILE_BACKUP"), false );
     XmlOptions::get().set<bool>( QStringLiteral("AUTO_BACKUP"), true );
     XmlOptions::get().set<bool>( QStringLiteral("AUTO_SAVE"), false );
@@ -0,0 +1,137 @@
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "DeflateDevice.h"
+#include "Debug.h"
+
+#include <zlib.h>
+
+//_______________________________________________
+DeflateDevice::DeflateDevice( QIODevice* device, int level ):
+    Counter( QStringLiteral("DeflateDevice") ),
+    device_( device ),
+    level_( level ),
+    stream_( new z_stream_s )
+{}
+
+//_______________________________________________
+DeflateDevice::~DeflateDevice()
+{ close(); }
+
+//_______________________________________________
+bool DeflateDevice::open( OpenMode mode )
+{
+    Debug::Throw( QStringLiteral("DeflateDevice::open.\n") );
+
+    // only write mode is supported
+    if( ( mode & QIODevice::ReadOnly ) || !device_ || !device_->isWritable() ) return false;
+
+    // initialize stream
+    stream_->zalloc = Z_NULL;
+    stream_->zfree = Z_NULL;
+    stream_->opaque = Z_NULL;
+    if( deflateInit( stream_.get(), level_ ) != Z_OK ) return false;
+
+    // reserve room for uncompressed size header
+    size_ = 0;
+    headerPosition_ = device_->pos();
+    if( device_->write( QByteArray( 4, 0 ) ) != 4 )
+    {
+        deflateEnd( stream_.get() );
+        return false;
+    }
+
+    buffer_.resize( 1<<16 );
+    return QIODevice::open( mode );
+}
+
+//_______________________________________________
+void DeflateDevice::close()
+{ finish(); }
+
+//_______________________________________________
+bool DeflateDevice::finish()
+{
+    if( !isOpen() ) return false;
+    Debug::Throw( QStringLiteral("DeflateDevice::finish.\n") );
+
+    // flush remaining data
+    stream_->next_in = Z_NULL;
+    stream_->avail_in = 0;
+    bool success( _deflate( Z_FINISH ) );
+
+    // deflateEnd reports data discarded from an unfinished stream
+    if( deflateEnd( stream_.get() ) != Z_OK ) success = false;
+
+    // write uncompressed size header, same as qCompress
+    const char header[4] =
+    {
+        static_cast<char>( (size_ >> 24) & 0xff ),
+        static_cast<char>( (size_ >> 16) & 0xff ),
+        static_cast<char>( (size_ >> 8) & 0xff ),
+        static_cast<char>( size_ & 0xff )
+    };
+
+    const auto end( device_->pos() );
+    if( !( device_->seek( headerPosition_ ) && device_->write( header, 4 ) == 4 && device_->seek( end ) ) )
+    {
+        Debug::Throw(0) << "DeflateDevice::finish - unable to write size header." << Qt::endl;
+        success = false;
+    }
+
+    QIODevice::close();
+    return success;
+}
+
+//_______________________________________________
+qint64 DeflateDevice::writeData( const char* data, qint64 length )
+{
+    stream_->next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data ) );
+    stream_->avail_in = static_cast<uInt>( length );
+    if( !_deflate( Z_NO_FLUSH ) ) return -1;
+
+    size_ += length;
+    return length;
+}
+
+//_______________________________________________
+bool DeflateDevice::_deflate( int flush )
+{
+    do
+    {
+        stream_->next_out = reinterpret_cast<Bytef*>( buffer_.data() );
+        stream_->avail_out = static_cast<uInt>( buffer_.size() );
+        if( deflate( stream_.get(), flush ) == Z_STREAM_ERROR )
+        {
+            Debug::Throw(0) << "DeflateDevice::_deflate - compression failed." << Qt::endl;
+            return false;
+        }
+
+        const qint64 compressed( buffer_.size() - stream_->avail_out );
+        if( compressed > 0 && device_->write( buffer_.constData(), compressed ) != compressed )
+        {
+            Debug::Throw(0) << "DeflateDevice::_deflate - write failed." << Qt::endl;
+            return false;
+        }
+
+    } while( stream_->avail_out == 0 );
+
+    return true;
+}
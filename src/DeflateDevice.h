@@ -0,0 +1,116 @@
+#ifndef DeflateDevice_h
+#define DeflateDevice_h
+
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <memory>
+
+struct z_stream_s;
+
+/**
+\class DeflateDevice
+\brief write-only device that compresses data on the fly into an underlying device
+The output is compatible with qUncompress: a four bytes, big-endian uncompressed size header,
+followed by the zlib stream. The header is written on close, which requires the underlying device
+to be seekable.
+*/
+class DeflateDevice: public QIODevice, private Base::Counter<DeflateDevice>
+{
+
+    //* Qt meta object declaration
+    Q_OBJECT
+
+    public:
+
+    //* constructor
+    explicit DeflateDevice( QIODevice*, int level = -1 );
+
+    //* destructor
+    ~DeflateDevice() override;
+
+    //*@name accessors
+    //@{
+
+    //* sequential
+    bool isSequential() const override
+    { return true; }
+
+    //* number of uncompressed bytes written so far
+    qint64 uncompressedSize() const
+    { return size_; }
+
+    //@}
+
+    //*@name modifiers
+    //@{
+
+    //* open
+    bool open( OpenMode ) override;
+
+    //* close
+    /** errors are ignored. Use finish to check that all data was written */
+    void close() override;
+
+    //* flush remaining data, write size header and close. Returns false on error
+    bool finish();
+
+    //@}
+
+    protected:
+
+    //* read
+    qint64 readData( char*, qint64 ) override
+    { return -1; }
+
+    //* write
+    qint64 writeData( const char*, qint64 ) override;
+
+    private:
+
+    //* deflate pending input and write to device
+    bool _deflate( int );
+
+    //* output device
+    QIODevice* device_ = nullptr;
+
+    //* compression level
+    int level_ = -1;
+
+    //* zlib stream
+    std::unique_ptr<z_stream_s> stream_;
+
+    //* output buffer
+    QByteArray buffer_;
+
+    //* position of the size header in output device
+    qint64 headerPosition_ = 0;
+
+    //* uncompressed size
+    qint64 size_ = 0;
+
+};
+
+#endif
@@ -665,7 +665,7 @@ void EditionWindow::writeEntryToLogbook( bool updateSelection )
     statusBar_->label().setText( tr( "writting entry to logbook..." ) );
 
     // add entry to logbook, if needed
-    if( entryIsNew ) Base::Key::associate( entry, logbook->latestChild().get() );
+    if( entryIsNew ) logbook->childFor( entry )->addEntry( entry );
 
     // update this window title, set unmodified.
     setModified( false );
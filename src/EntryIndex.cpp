@@ -0,0 +1,45 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "EntryIndex.h"
+#include "LogEntry.h"
+
+//________________________________________________________
+EntryIndex::EntryIndex( const Base::KeySet<LogEntry>& entries )
+{
+    entries_.reserve( entries.size() );
+    for( const auto& entry:entries )
+    { insert( entry ); }
+}
+
+//________________________________________________________
+void EntryIndex::insert( LogEntry* entry )
+{ entries_.insert( entry->id(), entry ); }
+
+//________________________________________________________
+void EntryIndex::remove( LogEntry* entry )
+{ entries_.remove( entry->id(), entry ); }
+
+//________________________________________________________
+LogEntry* EntryIndex::find( quint64 id ) const
+{ return entries_.value( id, nullptr ); }
+
+//________________________________________________________
+int EntryIndex::count( quint64 id ) const
+{ return entries_.count( id ); }
@@ -0,0 +1,64 @@
+#ifndef EntryIndex_h
+#define EntryIndex_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Key.h"
+
+#include <QMultiHash>
+
+class LogEntry;
+
+/**
+\class EntryIndex
+\brief log entries indexed by identifier, used to find matching or duplicated entries in constant time.
+It must be kept up to date by its owner when entries are added or removed.
+*/
+class EntryIndex final
+{
+
+    public:
+
+    //* constructor
+    explicit EntryIndex() = default;
+
+    //* constructor from entries
+    explicit EntryIndex( const Base::KeySet<LogEntry>& );
+
+    //* add entry
+    void insert( LogEntry* );
+
+    //* remove entry
+    void remove( LogEntry* );
+
+    //* entry with given identifier, if any. Returns nullptr otherwise
+    LogEntry* find( quint64 ) const;
+
+    //* number of entries with given identifier
+    int count( quint64 ) const;
+
+    private:
+
+    //* entries
+    QMultiHash<quint64, LogEntry*> entries_;
+
+};
+
+#endif
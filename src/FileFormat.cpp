@@ -0,0 +1,367 @@
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "FileFormat.h"
+#include "Debug.h"
+
+#include <new>
+
+#if WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#if WITH_LZ4
+#include <lz4.h>
+#endif
+
+namespace
+{
+
+    namespace Local
+    {
+
+        //* magic string
+        static const QByteArray Magic( "ELGB" );
+
+        //________________________________________________________
+        QByteArray safeUncompress( const uchar* data, int size )
+        {
+            try
+            {
+
+                return qUncompress( data, size );
+
+            } catch( std::bad_alloc& exception ) {
+
+                Debug::Throw() << "safeUncompress - caught bad_alloc exception: " << exception.what() << Qt::endl;
+                return QByteArray();
+
+            }
+
+        }
+
+        #if WITH_ZSTD || WITH_LZ4
+        //________________________________________________________
+        //* append size as four bytes big-endian integer
+        void appendSize( QByteArray& out, int size )
+        {
+            out.append( static_cast<char>( (size >> 24) & 0xff ) );
+            out.append( static_cast<char>( (size >> 16) & 0xff ) );
+            out.append( static_cast<char>( (size >> 8) & 0xff ) );
+            out.append( static_cast<char>( size & 0xff ) );
+        }
+
+        //________________________________________________________
+        //* largest uncompressed size accepted when reading. Larger values denote a corrupted file
+        static const quint32 MaxSize = 1U<<30;
+
+        //________________________________________________________
+        //* read size from four bytes big-endian integer
+        quint32 readSize( const uchar* data )
+        { return (quint32(data[0]) << 24) | (quint32(data[1]) << 16) | (quint32(data[2]) << 8) | quint32(data[3]); }
+        #endif
+
+        #if WITH_ZSTD
+        //________________________________________________________
+        QByteArray zstdCompress( const QByteArray& content )
+        {
+            QByteArray out;
+            appendSize( out, content.size() );
+
+            const auto bound( ZSTD_compressBound( content.size() ) );
+            out.resize( 4 + static_cast<int>( bound ) );
+
+            const auto size( ZSTD_compress( out.data() + 4, bound, content.constData(), content.size(), ZSTD_CLEVEL_DEFAULT ) );
+            if( ZSTD_isError( size ) ) return QByteArray();
+
+            out.resize( 4 + static_cast<int>( size ) );
+            return out;
+        }
+
+        //________________________________________________________
+        bool zstdUncompress( const uchar* data, int size, QByteArray& out )
+        {
+            if( size < 4 ) return false;
+            const auto expected( readSize( data ) );
+            if( expected > MaxSize )
+            {
+                Debug::Throw(0) << "zstdUncompress - invalid size: " << expected << Qt::endl;
+                return false;
+            }
+
+            try
+            {
+
+                out.resize( static_cast<int>( expected ) );
+                const auto result( ZSTD_decompress( out.data(), out.size(), data + 4, size - 4 ) );
+                return !ZSTD_isError( result ) && result == static_cast<size_t>( out.size() );
+
+            } catch( std::bad_alloc& exception ) {
+
+                Debug::Throw() << "zstdUncompress - caught bad_alloc exception: " << exception.what() << Qt::endl;
+                return false;
+
+            }
+        }
+        #endif
+
+        #if WITH_LZ4
+        //________________________________________________________
+        QByteArray lz4Compress( const QByteArray& content )
+        {
+            QByteArray out;
+            appendSize( out, content.size() );
+
+            const int bound( LZ4_compressBound( content.size() ) );
+            out.resize( 4 + bound );
+
+            const int size( LZ4_compress_default( content.constData(), out.data() + 4, content.size(), bound ) );
+            if( size <= 0 && !content.isEmpty() ) return QByteArray();
+
+            out.resize( 4 + size );
+            return out;
+        }
+
+        //________________________________________________________
+        bool lz4Uncompress( const uchar* data, int size, QByteArray& out )
+        {
+            if( size < 4 ) return false;
+            const auto expected( readSize( data ) );
+            if( expected > MaxSize )
+            {
+                Debug::Throw(0) << "lz4Uncompress - invalid size: " << expected << Qt::endl;
+                return false;
+            }
+
+            try
+            {
+
+                out.resize( static_cast<int>( expected ) );
+                const int result( LZ4_decompress_safe( reinterpret_cast<const char*>( data + 4 ), out.data(), size - 4, out.size() ) );
+                return result == out.size();
+
+            } catch( std::bad_alloc& exception ) {
+
+                Debug::Throw() << "lz4Uncompress - caught bad_alloc exception: " << exception.what() << Qt::endl;
+                return false;
+
+            }
+        }
+        #endif
+
+        //________________________________________________________
+        //* true if content looks like plain xml
+        bool isXml( const QByteArray& content )
+        {
+            for( const auto& c:content )
+            {
+                if( c == '<' ) return true;
+                else if( !( c == ' ' || c == '\t' || c == '\n' || c == '\r' ) ) return content.startsWith( "\xef\xbb\xbf" );
+            }
+
+            return false;
+        }
+
+        //________________________________________________________
+        //* true if content looks like legacy, qCompress output
+        /** four bytes big-endian size, followed by a zlib stream header */
+        bool isLegacyCompressed( const QByteArray& content )
+        {
+            if( content.size() < 6 ) return false;
+            const int cmf( static_cast<uchar>( content[4] ) );
+            const int flg( static_cast<uchar>( content[5] ) );
+            return (cmf & 0x0f) == 8 && (cmf >> 4) <= 7 && ((cmf << 8) | flg) % 31 == 0;
+        }
+
+    }
+
+}
+
+//________________________________________________________
+FileFormat::Codec FileFormat::defaultCodec()
+{ return isSupported( Codec::Zstd ) ? Codec::Zstd:Codec::Zlib; }
+
+//________________________________________________________
+bool FileFormat::isSupported( Codec codec )
+{
+    switch( codec )
+    {
+        case Codec::None:
+        case Codec::Zlib:
+        return true;
+
+        case Codec::Zstd:
+        return WITH_ZSTD;
+
+        case Codec::Lz4:
+        return WITH_LZ4;
+
+        default:
+        return false;
+    }
+}
+
+//________________________________________________________
+FileFormat::Codec FileFormat::codec( const QString& value )
+{
+    for( const auto& codec:{ Codec::None, Codec::Zlib, Codec::Zstd, Codec::Lz4 } )
+    {
+        if( value.compare( name( codec ), Qt::CaseInsensitive ) == 0 )
+        { return isSupported( codec ) ? codec:defaultCodec(); }
+    }
+
+    return defaultCodec();
+}
+
+//________________________________________________________
+QString FileFormat::name( Codec codec )
+{
+    switch( codec )
+    {
+        case Codec::None: return QStringLiteral( "none" );
+        case Codec::Zlib: return QStringLiteral( "zlib" );
+        case Codec::Zstd: return QStringLiteral( "zstd" );
+        case Codec::Lz4: return QStringLiteral( "lz4" );
+        default: return QString();
+    }
+}
+
+//________________________________________________________
+QByteArray FileFormat::header( Codec codec )
+{
+    QByteArray out( Local::Magic );
+    out.append( static_cast<char>( Version ) );
+    out.append( static_cast<char>( codec ) );
+    out.append( 2, 0 );
+    return out;
+}
+
+//________________________________________________________
+bool FileFormat::readHeader( const QByteArray& content, Codec& codec )
+{
+    if( content.size() < HeaderSize || !content.startsWith( Local::Magic ) ) return false;
+    codec = static_cast<Codec>( content[5] );
+    return true;
+}
+
+//________________________________________________________
+QByteArray FileFormat::encode( const QByteArray& content, Codec codec )
+{
+    switch( codec )
+    {
+        case Codec::Zlib: return header( codec ) + qCompress( content );
+
+        #if WITH_ZSTD
+        case Codec::Zstd:
+        {
+            const auto compressed( Local::zstdCompress( content ) );
+            if( !compressed.isEmpty() ) return header( codec ) + compressed;
+            else return header( Codec::Zlib ) + qCompress( content );
+        }
+        #endif
+
+        #if WITH_LZ4
+        case Codec::Lz4:
+        {
+            const auto compressed( Local::lz4Compress( content ) );
+            if( !compressed.isEmpty() ) return header( codec ) + compressed;
+            else return header( Codec::Zlib ) + qCompress( content );
+        }
+        #endif
+
+        case Codec::None: return content;
+
+        // unsupported codecs fall back to zlib
+        default: return header( Codec::Zlib ) + qCompress( content );
+    }
+}
+
+//________________________________________________________
+bool FileFormat::decode( const QByteArray& content, QByteArray& out, QString& error )
+{
+
+    Codec codec( Codec::None );
+    if( readHeader( content, codec ) )
+    {
+
+        // check version
+        const int version( static_cast<uchar>( content[4] ) );
+        if( version > Version )
+        {
+            error = QStringLiteral( "unsupported file format version %1" ).arg( version );
+            return false;
+        }
+
+        const auto data( reinterpret_cast<const uchar*>( content.constData() ) + HeaderSize );
+        const int size( content.size() - HeaderSize );
+        switch( codec )
+        {
+            case Codec::None:
+            out = content.mid( HeaderSize );
+            return true;
+
+            case Codec::Zlib:
+            out = Local::safeUncompress( data, size );
+            if( out.isEmpty() && size > 0 )
+            {
+                error = QStringLiteral( "unable to uncompress zlib content" );
+                return false;
+            }
+            return true;
+
+            #if WITH_ZSTD
+            case Codec::Zstd:
+            if( !Local::zstdUncompress( data, size, out ) )
+            {
+                error = QStringLiteral( "unable to uncompress zstd content" );
+                return false;
+            }
+            return true;
+            #endif
+
+            #if WITH_LZ4
+            case Codec::Lz4:
+            if( !Local::lz4Uncompress( data, size, out ) )
+            {
+                error = QStringLiteral( "unable to uncompress lz4 content" );
+                return false;
+            }
+            return true;
+            #endif
+
+            default:
+            error = QStringLiteral( "unsupported codec %1" ).arg( static_cast<int>( codec ) );
+            return false;
+        }
+
+    }
+
+    // legacy files, with no header
+    if( !Local::isXml( content ) && Local::isLegacyCompressed( content ) )
+    {
+        out = Local::safeUncompress( reinterpret_cast<const uchar*>( content.constData() ), content.size() );
+        if( !out.isEmpty() ) return true;
+    }
+
+    // raw content
+    out = content;
+    return true;
+
+}
@@ -0,0 +1,84 @@
+#ifndef FileFormat_h
+#define FileFormat_h
+
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <QByteArray>
+#include <QString>
+
+/**
+logbook file format.
+Compressed files start with an eight bytes header:
+a four bytes magic string, the format version, the codec, and two reserved bytes.
+For all codecs, the payload starts with the uncompressed size, as four bytes big-endian integer,
+which makes zlib payload identical to qCompress output.
+Uncompressed files are stored as plain xml, with no header, so that they remain readable by any tool.
+Legacy files, with no header, are detected from their first bytes.
+*/
+namespace FileFormat
+{
+
+    //* codec
+    enum class Codec
+    {
+        None = 0,
+        Zlib = 1,
+        Zstd = 2,
+        Lz4 = 3
+    };
+
+    //* default codec for new files
+    /** zstd if available, zlib otherwise */
+    Codec defaultCodec();
+
+    //* true if codec is available in this build
+    bool isSupported( Codec );
+
+    //* codec from name. Returns default codec if name is not recognized or codec is not supported
+    Codec codec( const QString& );
+
+    //* codec name
+    QString name( Codec );
+
+    //* current format version
+    static const int Version = 1;
+
+    //* header size
+    static const int HeaderSize = 8;
+
+    //* header for a given codec
+    QByteArray header( Codec );
+
+    //* codec from content
+    /** returns true if content starts with a valid header */
+    bool readHeader( const QByteArray&, Codec& );
+
+    //* encode content, prepending the header
+    /** this is safe to be called from worker threads */
+    QByteArray encode( const QByteArray&, Codec );
+
+    //* decode file content
+    /** returns false and sets error string on failure. This is safe to be called from worker threads */
+    bool decode( const QByteArray&, QByteArray&, QString& );
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "FileSync.h"
+#include "Debug.h"
+
+#include <QDir>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+//________________________________________________________
+bool FileSync::sync( QFile& file )
+{
+    if( !file.flush() ) return false;
+
+    #if defined(Q_OS_WIN)
+    return _commit( file.handle() ) == 0;
+    #else
+    return ::fsync( file.handle() ) == 0;
+    #endif
+}
+
+//________________________________________________________
+bool FileSync::sync( const File& file )
+{
+    /* file is opened for appending, since syncing requires write access on some platforms */
+    QFile out( file );
+    if( !out.open( QIODevice::WriteOnly|QIODevice::Append ) ) return false;
+    return sync( out );
+}
+
+//________________________________________________________
+bool FileSync::syncDirectory( const File& directory )
+{
+
+    #if defined(Q_OS_WIN)
+
+    // directory entries cannot be synced explicitly, and are committed with the rename
+    Q_UNUSED( directory )
+    return true;
+
+    #else
+
+    const int handle( ::open( QFile::encodeName( directory ).constData(), O_RDONLY ) );
+    if( handle < 0 ) return false;
+
+    const bool out( ::fsync( handle ) == 0 );
+    ::close( handle );
+    return out;
+
+    #endif
+
+}
+
+//________________________________________________________
+bool FileSync::replace( const File& source, const File& destination )
+{
+
+    #if defined(Q_OS_WIN)
+    const bool out( MoveFileExW(
+        reinterpret_cast<const wchar_t*>( QDir::toNativeSeparators( source ).utf16() ),
+        reinterpret_cast<const wchar_t*>( QDir::toNativeSeparators( destination ).utf16() ),
+        MOVEFILE_REPLACE_EXISTING|MOVEFILE_WRITE_THROUGH ) );
+    #else
+    const bool out( ::rename( QFile::encodeName( source ).constData(), QFile::encodeName( destination ).constData() ) == 0 );
+    #endif
+
+    if( !out ) Debug::Throw(0) << "FileSync::replace - unable to rename " << source << " to " << destination << Qt::endl;
+    return out;
+
+}
@@ -0,0 +1,48 @@
+#ifndef FileSync_h
+#define FileSync_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "File.h"
+
+#include <QFile>
+
+/**
+durable file operations.
+They are safe to be called from worker threads.
+*/
+namespace FileSync
+{
+
+    //* flush open file content to disk. Returns true on success
+    bool sync( QFile& );
+
+    //* flush file content to disk. Returns true on success
+    bool sync( const File& );
+
+    //* flush directory entries to disk, so that renamed files persist. Returns true on success
+    bool syncDirectory( const File& );
+
+    //* atomically replace destination file by source file. Returns true on success
+    bool replace( const File& source, const File& destination );
+
+}
+
+#endif
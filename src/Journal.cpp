@@ -0,0 +1,157 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Journal.h"
+#include "Debug.h"
+#include "FileSync.h"
+#include "Snapshot.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+
+namespace
+{
+
+    namespace Local
+    {
+
+        //* magic string
+        static const QByteArray Magic( "ELGJ" );
+
+        //________________________________________________________
+        //* record checksum
+        QByteArray checksum( const QByteArray& data )
+        { return QCryptographicHash::hash( data, QCryptographicHash::Md5 ); }
+
+    }
+
+}
+
+//________________________________________________________
+File Journal::file( const File& file )
+{ return File( QStringLiteral( ".%1.journal" ).arg( file.localName().get() ) ).addPath( file.path() ); }
+
+//________________________________________________________
+bool Journal::append( const File& source, const Record::List& records )
+{
+
+    QFile out( file( source ) );
+    const bool isNew( !out.exists() || out.size() == 0 );
+    if( !out.open( QIODevice::WriteOnly|QIODevice::Append ) )
+    {
+        Debug::Throw(0) << "Journal::append - unable to open " << out.fileName() << Qt::endl;
+        return false;
+    }
+
+    QDataStream stream( &out );
+    Snapshot::setup( stream );
+
+    // header
+    if( isNew )
+    {
+        out.write( Local::Magic );
+        stream << quint32( Version );
+    }
+
+    // records
+    for( const auto& record:records )
+    {
+
+        QByteArray data;
+        QDataStream recordStream( &data, QIODevice::WriteOnly );
+        Snapshot::setup( recordStream );
+        recordStream << quint8( record.action ) << record.id;
+        Snapshot::writeTimeStamp( recordStream, record.creation );
+        if( record.action == Action::Write ) recordStream << record.data;
+
+        stream << data << Local::checksum( data );
+
+    }
+
+    return stream.status() == QDataStream::Ok && FileSync::sync( out );
+
+}
+
+//________________________________________________________
+Journal::Record::List Journal::read( const File& source )
+{
+
+    Record::List out;
+
+    QFile in( file( source ) );
+    if( !in.open( QIODevice::ReadOnly ) ) return out;
+
+    // magic and version
+    if( in.read( Local::Magic.size() ) != Local::Magic ) return out;
+
+    QDataStream stream( &in );
+    Snapshot::setup( stream );
+
+    quint32 version( 0 );
+    stream >> version;
+    if( version != Version )
+    {
+        Debug::Throw(0) << "Journal::read - unsupported version for " << in.fileName() << Qt::endl;
+        return out;
+    }
+
+    // records, up to the first incomplete one
+    qint64 validSize( in.pos() );
+    while( !stream.atEnd() )
+    {
+
+        QByteArray data;
+        QByteArray checksum;
+        stream >> data >> checksum;
+        if( stream.status() != QDataStream::Ok || checksum != Local::checksum( data ) )
+        {
+            // truncate, so that records appended later on are not lost
+            Debug::Throw(0) << "Journal::read - incomplete record in " << in.fileName() << Qt::endl;
+            in.close();
+            QFile::resize( file( source ), validSize );
+            break;
+        }
+
+        QDataStream recordStream( data );
+        Snapshot::setup( recordStream );
+
+        Record record;
+        quint8 action( 0 );
+        recordStream >> action >> record.id;
+        record.action = Action( action );
+        record.creation = Snapshot::readTimeStamp( recordStream );
+        if( record.action == Action::Write ) recordStream >> record.data;
+        if( recordStream.status() != QDataStream::Ok ) break;
+
+        out.append( record );
+        validSize = in.pos();
+
+    }
+
+    return out;
+
+}
+
+//________________________________________________________
+bool Journal::remove( const File& source )
+{
+    QFile journal( file( source ) );
+    return !journal.exists() || journal.remove();
+}
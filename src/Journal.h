@@ -0,0 +1,91 @@
+#ifndef Journal_h
+#define Journal_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "File.h"
+#include "TimeStamp.h"
+
+#include <QByteArray>
+#include <QList>
+
+/**
+append-only journal of entry changes, stored as a hidden sidecar file next to the top-level logbook file.
+Each record is checksummed and synced to disk when appended. Records are replayed in order when the logbook is read,
+up to the first incomplete one, and the journal is removed once the logbook files are fully written.
+Entries are identified by their identifier. Their creation time stamp is used to load the children holding them.
+*/
+namespace Journal
+{
+
+    //* record format version
+    static const int Version = 3;
+
+    //* journal size above which the logbook files must be written
+    static const qint64 MaxSize = 1<<20;
+
+    //* record action
+    enum class Action: quint8
+    {
+        //* entry added or modified
+        Write,
+
+        //* entry removed
+        Remove
+    };
+
+    //* journal record
+    class Record
+    {
+
+        public:
+
+        //* list
+        using List = QList<Record>;
+
+        //* action
+        Action action = Action::Write;
+
+        //* entry identifier
+        quint64 id = 0;
+
+        //* entry creation time stamp
+        TimeStamp creation;
+
+        //* entry binary snapshot, for write action
+        QByteArray data;
+
+    };
+
+    //* journal file associated to a logbook file
+    File file( const File& );
+
+    //* append records to journal, and sync to disk. Returns true on success
+    bool append( const File&, const Record::List& );
+
+    //* read valid records from journal
+    Record::List read( const File& );
+
+    //* remove journal. Returns true on success or if there is no journal
+    bool remove( const File& );
+
+}
+
+#endif
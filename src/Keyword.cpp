@@ -21,9 +21,28 @@
 #include "Debug.h"
 #include "XmlDef.h"
 
-
+#include <QHash>
 #include <QObject>
 
+#include <deque>
+
+//_________________________________________________________________
+class Keyword::Node
+{
+
+    public:
+
+    //* normalized value
+    QString value;
+
+    //* parent node. Root is its own parent
+    const Node* parent = nullptr;
+
+    //* number of ancestors
+    int depth = 0;
+
+};
+
 //_________________________________________________________________
 const Keyword Keyword::Default( QObject::tr( "New entries" ) );
 const QString Keyword::MimeType( QStringLiteral("logbook/keyword-list") );
@@ -31,51 +50,76 @@ const QString Keyword::MimeType( QStringLiteral("logbook/keyword-list") );
 //_________________________________________________________________
 Keyword::Keyword( const QString &value):
     Counter( QStringLiteral("Keyword") ),
-    value_( _format( value ) )
+    node_( _intern( value ) )
 {}
 
 //_________________________________________________________________
 Keyword::Keyword( const QDomElement& element ):
     Counter( QStringLiteral("Keyword") ),
-    value_( _format( element.text() ) )
+    node_( _intern( element.text() ) )
+{}
+
+//_________________________________________________________________
+Keyword::Keyword( QXmlStreamReader& reader ):
+    Counter( QStringLiteral("Keyword") ),
+    node_( _intern( reader.readElementText( QXmlStreamReader::IncludeChildElements ) ) )
 {}
 
 //_________________________________________________________________
 QDomElement Keyword::domElement( QDomDocument& document ) const
 {
     QDomElement out( document.createElement( Xml::Keyword ) );
-    out.appendChild( document.createTextNode( value_ ) );
+    out.appendChild( document.createTextNode( get() ) );
     return out;
 }
 
+//_________________________________________________________________
+void Keyword::writeXml( QXmlStreamWriter& writer ) const
+{ writer.writeTextElement( Xml::Keyword, get() ); }
+
+//_________________________________________________________________
+const QString& Keyword::get() const
+{ return node_->value; }
+
+//_________________________________________________________________
+bool Keyword::isRoot() const
+{ return node_->parent == node_; }
+
 //_________________________________________________________________
 QString Keyword::current() const
 {
 
-    int pos = value_.lastIndexOf( '/' );
-    return ( pos >= 0 ) ? value_.mid( pos+1 ):value_;
+    const auto& value( get() );
+    int pos = value.lastIndexOf( '/' );
+    return ( pos >= 0 ) ? value.mid( pos+1 ):value;
 
 }
 
 //_________________________________________________________________
 Keyword Keyword::parent() const
 {
-    const int pos = value_.lastIndexOf( '/' );
-    return Keyword( value_.left( pos ) );
+    Keyword out( *this );
+    out.node_ = node_->parent;
+    return out;
 }
 
 //_______________________________________________
 bool Keyword::isChild( const Keyword& keyword ) const
-{ return parent() == keyword; }
+{ return node_->parent == keyword.node_; }
 
 //_______________________________________________
 bool Keyword::inherits( const Keyword& keyword ) const
 {
 
-    if( *this == keyword ) return true;
-    if( get().size() < keyword.get().size() ) return false;
-    int pos( get().indexOf( keyword.get() ) );
-    return pos == 0 && get()[keyword.get().size()]=='/';
+    if( node_ == keyword.node_ ) return true;
+
+    // root is only inherited by itself
+    if( keyword.isRoot() ) return false;
+
+    // walk up to the argument depth
+    auto node( node_ );
+    while( node->depth > keyword.node_->depth ) node = node->parent;
+    return node == keyword.node_;
 
 }
 
@@ -87,18 +131,19 @@ Keyword& Keyword::append( const QString &value )
     if( value.isEmpty() || value == QLatin1String("/") ) return *this;
 
     // make sure leading "/" is added
-    if( value.startsWith( '/' ) || value_.endsWith( '/' ) ) value_ += value;
-    else value_ += QString( '/' ) + value;
+    QString out( get() );
+    if( value.startsWith( '/' ) || out.endsWith( '/' ) ) out += value;
+    else out += QString( '/' ) + value;
 
     // reformat
-    value_ = _format( value_ );
+    node_ = _intern( out );
 
     return *this;
 
 }
 
 //_________________________________________________________________
-QString Keyword::_format( QString value ) const
+QString Keyword::_format( QString value )
 {
 
     // make sure value is not empty
@@ -123,3 +168,41 @@ QString Keyword::_format( QString value ) const
 
     return out;
 }
+
+//_________________________________________________________________
+const Keyword::Node* Keyword::_intern( const QString& value )
+{
+
+    /*
+    the pool is not thread safe. Keywords are only created from the main thread,
+    since logbook worker threads only read and write raw file content.
+    Nodes are stored in a deque, for their address to remain valid, and are never removed
+    */
+    static QHash<QString, const Node*> nodes;
+    static std::deque<Node> storage;
+
+    // raw and normalized values are both registered, so that formatting is skipped for known values
+    const auto iter( nodes.constFind( value ) );
+    if( iter != nodes.constEnd() ) return iter.value();
+
+    // intern parent first
+    const auto formatted( _format( value ) );
+    const Node* parent( nullptr );
+    if( formatted != QLatin1String("/") ) parent = _intern( formatted.left( formatted.lastIndexOf( '/' ) ) );
+
+    auto node( nodes.value( formatted, nullptr ) );
+    if( !node )
+    {
+        storage.emplace_back();
+        auto& newNode( storage.back() );
+        newNode.value = formatted;
+        newNode.parent = parent ? parent:&newNode;
+        newNode.depth = parent ? parent->depth+1:0;
+        node = &newNode;
+        nodes.insert( formatted, node );
+    }
+
+    nodes.insert( value, node );
+    return node;
+
+}
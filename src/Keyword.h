@@ -29,8 +29,18 @@
 #include <QString>
 #include <QTextStream>
 #include <QVector>
-
-//* log entry keyword
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+/**
+\class Keyword
+\brief log entry keyword.
+It is a handle to a normalized value, interned in a process-wide pool,
+together with a handle to its parent. Equality, hashing and inheritance are therefore pointer operations.
+Interned values are never released: the pool grows with every keyword value ever created during the session,
+including renamed keywords and intermediate values built by append().
+The pool is not thread safe, and keywords must be created from the main thread.
+*/
 class Keyword final: private Base::Counter<Keyword>
 {
 
@@ -48,6 +58,9 @@ class Keyword final: private Base::Counter<Keyword>
     //* constructor from DOM
     explicit Keyword( const QDomElement& );
 
+    //* constructor from xml stream
+    explicit Keyword( QXmlStreamReader& );
+
     //* keyword set
     using Set = QSet<Keyword>;
     using OrderedSet = QOrderedSet<Keyword>;
@@ -59,13 +72,14 @@ class Keyword final: private Base::Counter<Keyword>
     //* DomElement
     QDomElement domElement( QDomDocument& ) const;
 
+    //* write to xml stream
+    void writeXml( QXmlStreamWriter& ) const;
+
     //* full keyword
-    const QString& get() const
-    { return value_; }
+    const QString& get() const;
 
     //* true if is root
-    bool isRoot() const
-    { return value_.isEmpty() || value_ == QString( '/' ); }
+    bool isRoot() const;
 
     //* current keyword
     QString current() const;
@@ -86,11 +100,11 @@ class Keyword final: private Base::Counter<Keyword>
 
     //* clear
     void clear()
-    { value_ = _format( QString() ); }
+    { node_ = _intern( QString() ); }
 
     //* set full keyword
     void set( const QString &value )
-    { value_ = _format( value ); }
+    { node_ = _intern( value ); }
 
     //* append
     Keyword& append( const QString &value );
@@ -99,11 +113,17 @@ class Keyword final: private Base::Counter<Keyword>
 
     private:
 
+    //* interned keyword
+    class Node;
+
     //* format keyword
-    QString _format( QString ) const;
+    static QString _format( QString );
+
+    //* interned node matching value, created if needed
+    static const Node* _intern( const QString& );
 
-    //* full value
-    QString value_;
+    //* interned node
+    const Node* node_ = nullptr;
 
     //* streamer
     friend QTextStream& operator << (QTextStream& out, const Keyword& keyword )
@@ -111,18 +131,19 @@ class Keyword final: private Base::Counter<Keyword>
         out << keyword.get();
         return out;
     }
-};
 
-//* equal to operator
-inline bool operator == (const Keyword& first, const Keyword& second)
-{ return first.get() == second.get(); }
+    //* equal to operator
+    friend bool operator == (const Keyword& first, const Keyword& second)
+    { return first.node_ == second.node_; }
+
+    //* hash
+    friend uint qHash( const Keyword& keyword )
+    { return qHash( keyword.node_ ); }
+
+};
 
 //* less than operator
 inline bool operator < (const Keyword& first, const Keyword& second)
 { return first.get() < second.get(); }
 
-//* hash
-inline uint qHash( const Keyword& keyword )
-{ return qHash( keyword.get() ); }
-
 #endif
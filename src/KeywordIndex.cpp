@@ -0,0 +1,111 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "KeywordIndex.h"
+#include "LogEntry.h"
+
+//________________________________________________________
+Base::KeySet<LogEntry> KeywordIndex::entries( const Keyword& keyword ) const
+{
+    const auto iter( nodes_.constFind( keyword ) );
+    return iter == nodes_.constEnd() ? Base::KeySet<LogEntry>():iter.value().entries;
+}
+
+//________________________________________________________
+Base::KeySet<LogEntry> KeywordIndex::inheritingEntries( const Keyword& keyword ) const
+{
+    Base::KeySet<LogEntry> out;
+    for( const auto& child:inheritingKeywords( keyword ) )
+    { out.unite( nodes_.value( child ).entries ); }
+
+    return out;
+}
+
+//________________________________________________________
+Keyword::List KeywordIndex::inheritingKeywords( const Keyword& keyword ) const
+{
+
+    Keyword::List out;
+    if( !nodes_.contains( keyword ) ) return out;
+
+    // depth first traversal of the sub-tree
+    Keyword::List pending( { keyword } );
+    while( !pending.empty() )
+    {
+        const auto current( pending.takeLast() );
+        const auto node( nodes_.value( current ) );
+        if( !node.entries.empty() ) out.append( current );
+        for( const auto& child:node.children )
+        { pending.append( child ); }
+    }
+
+    return out;
+
+}
+
+//________________________________________________________
+void KeywordIndex::insert( LogEntry* entry )
+{
+    for( const auto& keyword:entry->keywords() )
+    { insert( entry, keyword ); }
+}
+
+//________________________________________________________
+void KeywordIndex::remove( LogEntry* entry )
+{
+    for( const auto& keyword:entry->keywords() )
+    { remove( entry, keyword ); }
+}
+
+//________________________________________________________
+void KeywordIndex::insert( LogEntry* entry, const Keyword& keyword )
+{
+
+    nodes_[keyword].entries.insert( entry );
+
+    // link to ancestors, up to the first one already linked
+    for( auto current = keyword; !current.isRoot(); current = current.parent() )
+    {
+        auto& children( nodes_[current.parent()].children );
+        if( children.contains( current ) ) break;
+        children.insert( current );
+    }
+
+}
+
+//________________________________________________________
+void KeywordIndex::remove( LogEntry* entry, const Keyword& keyword )
+{
+
+    auto iter( nodes_.find( keyword ) );
+    if( iter == nodes_.end() ) return;
+    iter.value().entries.remove( entry );
+
+    // remove nodes left without entries nor children, up to the root
+    for( auto current = keyword; ; current = current.parent() )
+    {
+        iter = nodes_.find( current );
+        if( iter == nodes_.end() || !( iter.value().entries.empty() && iter.value().children.empty() ) ) break;
+        nodes_.erase( iter );
+
+        if( current.isRoot() ) break;
+        nodes_[current.parent()].children.remove( current );
+    }
+
+}
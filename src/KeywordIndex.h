@@ -0,0 +1,102 @@
+#ifndef KeywordIndex_h
+#define KeywordIndex_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+
+#include "Key.h"
+#include "Keyword.h"
+
+#include <QHash>
+
+class LogEntry;
+
+/**
+\class KeywordIndex
+\brief log entries indexed by keyword, on a path trie.
+Each node holds the entries with matching keyword, and the child keywords that have entries in their descendance.
+It is maintained incrementally by the top-level logbook, when entries are added or removed, and when their keywords change.
+*/
+class KeywordIndex final
+{
+
+    public:
+
+    //* constructor
+    explicit KeywordIndex() = default;
+
+    //*@name accessors
+    //@{
+
+    //* entries with given keyword
+    Base::KeySet<LogEntry> entries( const Keyword& ) const;
+
+    //* entries with given keyword, or any of its descendants
+    Base::KeySet<LogEntry> inheritingEntries( const Keyword& ) const;
+
+    //* given keyword and its descendants, for those that have entries
+    Keyword::List inheritingKeywords( const Keyword& ) const;
+
+    //@}
+
+    //*@name modifiers
+    //@{
+
+    //* add entry, with all its keywords
+    void insert( LogEntry* );
+
+    //* remove entry, with all its keywords
+    void remove( LogEntry* );
+
+    //* add entry keyword
+    void insert( LogEntry*, const Keyword& );
+
+    //* remove entry keyword
+    void remove( LogEntry*, const Keyword& );
+
+    //* clear
+    void clear()
+    { nodes_.clear(); }
+
+    //@}
+
+    private:
+
+    //* trie node
+    class Node
+    {
+
+        public:
+
+        //* entries with this node keyword
+        Base::KeySet<LogEntry> entries;
+
+        //* child keywords
+        Keyword::Set children;
+
+    };
+
+    //* nodes, by keyword
+    /** keywords are interned, so that lookup is a pointer hash */
+    QHash<Keyword, Node> nodes_;
+
+};
+
+#endif
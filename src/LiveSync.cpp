@@ -0,0 +1,386 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "LiveSync.h"
+#include "Debug.h"
+#include "Logbook.h"
+#include "Snapshot.h"
+
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+namespace
+{
+
+    namespace Local
+    {
+
+        //* time to wait for an existing server to accept connection (ms)
+        static const int ConnectTimeout = 1000;
+
+    }
+
+}
+
+//________________________________________________________
+LiveSync::LiveSync( QObject* parent ):
+    QObject( parent ),
+    Counter( QStringLiteral("LiveSync") )
+{}
+
+//________________________________________________________
+void LiveSync::setLogbook( Logbook* logbook )
+{
+    Debug::Throw( QStringLiteral("LiveSync::setLogbook.\n") );
+    logbook_ = logbook;
+
+    // let peer know about new entries
+    if( socket_ && logbook_ )
+    {
+        _sendManifest();
+        update();
+    }
+}
+
+//________________________________________________________
+void LiveSync::start( const QString& channel )
+{
+
+    Debug::Throw() << "LiveSync::start - channel: " << channel << Qt::endl;
+    stop();
+    channel_ = channel;
+
+    // listen
+    server_ = new QLocalServer( this );
+    if( server_->listen( channel_ ) )
+    {
+        connect( server_, &QLocalServer::newConnection, this, &LiveSync::_newConnection );
+        return;
+    }
+
+    delete server_;
+    server_ = nullptr;
+
+    // connect to the instance already listening
+    auto socket( new QLocalSocket( this ) );
+    socket->connectToServer( channel_ );
+    if( socket->waitForConnected( Local::ConnectTimeout ) )
+    {
+        _setSocket( socket );
+        return;
+    }
+
+    delete socket;
+
+    // no instance is listening. The server left over by an instance that crashed is removed
+    QLocalServer::removeServer( channel_ );
+    server_ = new QLocalServer( this );
+    if( server_->listen( channel_ ) )
+    {
+        connect( server_, &QLocalServer::newConnection, this, &LiveSync::_newConnection );
+        return;
+    }
+
+    Debug::Throw(0) << "LiveSync::start - unable to listen on " << channel_ << ": " << server_->errorString() << Qt::endl;
+    delete server_;
+    server_ = nullptr;
+
+}
+
+//________________________________________________________
+void LiveSync::stop()
+{
+
+    Debug::Throw( QStringLiteral("LiveSync::stop.\n") );
+    if( socket_ )
+    {
+        auto socket( socket_ );
+        socket_ = nullptr;
+        socket->disconnect( this );
+        socket->disconnectFromServer();
+        socket->deleteLater();
+        emit connectionChanged( false );
+    }
+
+    if( server_ )
+    {
+        server_->close();
+        delete server_;
+        server_ = nullptr;
+    }
+
+    manifestReceived_ = false;
+    peerLogbook_.clear();
+    peerEntries_.clear();
+
+}
+
+//________________________________________________________
+void LiveSync::update()
+{
+
+    if( !( logbook_ && isSynchronized() ) ) return;
+
+    // collect entries unknown to peer
+    QList<LogEntry*> entries;
+    for( const auto& entry:logbook_->entries() )
+    {
+        const auto id( entry->id() );
+        const auto key( _key( entry->contentHash() ) );
+        if( peerEntries_.value( id, 0 ) == key ) continue;
+
+        peerEntries_.insert( id, key );
+        entries.append( entry );
+    }
+
+    if( entries.empty() ) return;
+    Debug::Throw() << "LiveSync::update - sending " << entries.size() << " entries" << Qt::endl;
+
+    QByteArray payload;
+    QDataStream stream( &payload, QIODevice::WriteOnly );
+    Snapshot::setup( stream );
+    stream << quint8( Message::Entries ) << _logbookIdentity() << quint32( entries.size() );
+    for( const auto& entry:entries )
+    {
+        QByteArray data;
+        QDataStream entryStream( &data, QIODevice::WriteOnly );
+        Snapshot::setup( entryStream );
+        entry->writeSnapshot( entryStream );
+        stream << data;
+    }
+
+    _send( payload );
+
+}
+
+//________________________________________________________
+void LiveSync::_newConnection()
+{
+
+    Debug::Throw( QStringLiteral("LiveSync::_newConnection.\n") );
+    while( auto socket = server_->nextPendingConnection() )
+    {
+        // only one peer is supported
+        if( socket_ )
+        {
+            socket->disconnectFromServer();
+            socket->deleteLater();
+        } else _setSocket( socket );
+    }
+
+}
+
+//________________________________________________________
+void LiveSync::_setSocket( QLocalSocket* socket )
+{
+
+    Debug::Throw( QStringLiteral("LiveSync::_setSocket.\n") );
+    socket_ = socket;
+    connect( socket_, &QLocalSocket::readyRead, this, &LiveSync::_read );
+    connect( socket_, &QLocalSocket::disconnected, this, &LiveSync::_disconnected );
+
+    manifestReceived_ = false;
+    peerLogbook_.clear();
+    peerEntries_.clear();
+    if( logbook_ ) _sendManifest();
+
+    emit connectionChanged( true );
+
+}
+
+//________________________________________________________
+void LiveSync::_read()
+{
+
+    if( !socket_ ) return;
+
+    QDataStream stream( socket_ );
+    Snapshot::setup( stream );
+    while( socket_ && socket_->bytesAvailable() )
+    {
+
+        // wait for complete messages
+        QByteArray payload;
+        stream.startTransaction();
+        stream >> payload;
+        if( !stream.commitTransaction() ) return;
+
+        QDataStream payloadStream( payload );
+        Snapshot::setup( payloadStream );
+
+        quint8 message( 0 );
+        payloadStream >> message;
+        switch( Message( message ) )
+        {
+            case Message::Manifest: _processManifest( payloadStream ); break;
+            case Message::Entries: _processEntries( payloadStream ); break;
+            default:
+            Debug::Throw(0) << "LiveSync::_read - unknown message " << message << Qt::endl;
+            break;
+        }
+
+    }
+
+}
+
+//________________________________________________________
+void LiveSync::_disconnected()
+{
+
+    Debug::Throw( QStringLiteral("LiveSync::_disconnected.\n") );
+    if( !socket_ ) return;
+
+    socket_->deleteLater();
+    socket_ = nullptr;
+    manifestReceived_ = false;
+    peerLogbook_.clear();
+    peerEntries_.clear();
+    emit connectionChanged( false );
+
+    // take over the channel when the listening instance is gone
+    if( !server_ ) start( channel_ );
+
+}
+
+//________________________________________________________
+void LiveSync::_send( const QByteArray& payload )
+{
+    QDataStream stream( socket_ );
+    Snapshot::setup( stream );
+    stream << payload;
+}
+
+//________________________________________________________
+void LiveSync::_sendManifest()
+{
+
+    Debug::Throw( QStringLiteral("LiveSync::_sendManifest.\n") );
+
+    const auto entries( logbook_->entries() );
+
+    QByteArray payload;
+    QDataStream stream( &payload, QIODevice::WriteOnly );
+    Snapshot::setup( stream );
+    stream << quint8( Message::Manifest ) << quint32( Version ) << _logbookIdentity() << quint32( entries.size() );
+    for( const auto& entry:entries )
+    { stream << entry->id() << _key( entry->contentHash() ); }
+
+    _send( payload );
+
+}
+
+//________________________________________________________
+void LiveSync::_processManifest( QDataStream& stream )
+{
+
+    quint32 version( 0 );
+    stream >> version;
+    if( version != Version )
+    {
+        Debug::Throw(0) << "LiveSync::_processManifest - unsupported version " << version << Qt::endl;
+        stop();
+        return;
+    }
+
+    // entries are only exchanged when peer has the same logbook opened
+    quint32 count( 0 );
+    stream >> peerLogbook_ >> count;
+    if( peerLogbook_ != _logbookIdentity() )
+    { Debug::Throw() << "LiveSync::_processManifest - peer logbook differs: " << peerLogbook_ << Qt::endl; }
+
+    Debug::Throw() << "LiveSync::_processManifest - " << count << " entries" << Qt::endl;
+    peerEntries_.clear();
+    peerEntries_.reserve( count );
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    {
+        quint64 id( 0 );
+        quint64 key( 0 );
+        stream >> id >> key;
+        peerEntries_.insert( id, key );
+    }
+
+    manifestReceived_ = true;
+    update();
+
+}
+
+//________________________________________________________
+void LiveSync::_processEntries( QDataStream& stream )
+{
+
+    // entries sent for another logbook are discarded. This happens when either side changes logbook
+    QString identity;
+    quint32 count( 0 );
+    stream >> identity >> count;
+    if( identity.isEmpty() || identity != _logbookIdentity() )
+    {
+        Debug::Throw() << "LiveSync::_processEntries - discarding entries from logbook " << identity << Qt::endl;
+        return;
+    }
+
+    Logbook logbook;
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    {
+        QByteArray data;
+        stream >> data;
+
+        QDataStream entryStream( data );
+        Snapshot::setup( entryStream );
+        auto entry( new LogEntry( entryStream ) );
+        if( entryStream.status() != QDataStream::Ok )
+        {
+            Debug::Throw(0) << "LiveSync::_processEntries - invalid entry" << Qt::endl;
+            delete entry;
+            continue;
+        }
+
+        peerEntries_.insert( entry->id(), _key( entry->contentHash() ) );
+        logbook.addEntry( entry );
+    }
+
+    Debug::Throw() << "LiveSync::_processEntries - received " << logbook.entries().size() << " entries" << Qt::endl;
+    if( logbook_ && !logbook.entries().empty() )
+    {
+        emit entriesReceived( logbook );
+
+        // send back entries that differ from received ones, once merged
+        update();
+    }
+
+}
+
+//________________________________________________________
+QString LiveSync::_logbookIdentity() const
+{
+    if( !logbook_ || logbook_->file().isEmpty() ) return QString();
+
+    // symbolic links are resolved, for all links to a logbook to match
+    const auto canonical( QFileInfo( logbook_->file() ).canonicalFilePath() );
+    return canonical.isEmpty() ? QString( logbook_->file() ):canonical;
+}
+
+//________________________________________________________
+quint64 LiveSync::_key( const LogEntry::ContentHash& hash )
+{
+    quint64 out( 0xcbf29ce484222325ULL );
+    for( const auto& value:{ hash.header, hash.text, hash.formats, hash.attachments } )
+    { out = ( out ^ value )*0x100000001b3ULL; }
+    return out;
+}
@@ -0,0 +1,168 @@
+#ifndef LiveSync_h
+#define LiveSync_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Counter.h"
+#include "LogEntry.h"
+
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class Logbook;
+class QLocalServer;
+class QLocalSocket;
+
+/**
+\class LiveSync
+\brief exchanges entry changes with another running instance, over a local socket.
+The first instance listens on the channel, the second one connects to it.
+Upon connection, each side sends the identity of its logbook, and the identifier and content hash of its loaded entries.
+When both sides have the same logbook opened, they then send whichever entries the other side does not have,
+or has with different content. Entries are never exchanged between different logbooks.
+Received entries are gathered in a temporary logbook, to be merged using Logbook::synchronize.
+Removed entries are not propagated, consistently with synchronization.
+*/
+class LiveSync: public QObject, private Base::Counter<LiveSync>
+{
+
+    //* Qt meta object declaration
+    Q_OBJECT
+
+    public:
+
+    //* protocol version
+    static const int Version = 3;
+
+    //* constructor
+    explicit LiveSync( QObject* = nullptr );
+
+    //*@name accessors
+    //@{
+
+    //* true if listening or connected
+    bool isStarted() const
+    { return server_ != nullptr || socket_ != nullptr; }
+
+    //* true if connected to peer
+    bool isConnected() const
+    { return socket_ != nullptr; }
+
+    //* true if connected to peer, with the same logbook opened
+    bool isSynchronized() const
+    { return socket_ && manifestReceived_ && !peerLogbook_.isEmpty() && peerLogbook_ == _logbookIdentity(); }
+
+    //@}
+
+    //*@name modifiers
+    //@{
+
+    //* set logbook which entries are exchanged
+    void setLogbook( Logbook* );
+
+    //* listen on channel, or connect to the instance already listening on it
+    void start( const QString& );
+
+    //* disconnect from peer and stop listening
+    void stop();
+
+    //* send entries added or modified since they were last sent or received
+    void update();
+
+    //@}
+
+    Q_SIGNALS:
+
+    //* emitted when entries are received from peer
+    /** they are held by a temporary logbook, and must be copied before returning */
+    void entriesReceived( Logbook& );
+
+    //* emitted when connection to peer is established or lost
+    void connectionChanged( bool );
+
+    private:
+
+    //* message type
+    enum class Message: quint8
+    {
+        //* logbook identity, identifier and content hash of all loaded entries
+        Manifest,
+
+        //* logbook identity and entry snapshots
+        Entries
+    };
+
+    //* new connection on server
+    void _newConnection();
+
+    //* connection to peer established
+    void _setSocket( QLocalSocket* );
+
+    //* read available messages
+    void _read();
+
+    //* connection to peer lost
+    void _disconnected();
+
+    //* send message payload
+    void _send( const QByteArray& );
+
+    //* send manifest
+    void _sendManifest();
+
+    //* process manifest
+    void _processManifest( QDataStream& );
+
+    //* process entries
+    void _processEntries( QDataStream& );
+
+    //* logbook identity, from its canonical file path. Empty if logbook is not set or has no file
+    QString _logbookIdentity() const;
+
+    //* content hash key
+    static quint64 _key( const LogEntry::ContentHash& );
+
+    //* logbook
+    Logbook* logbook_ = nullptr;
+
+    //* channel
+    QString channel_;
+
+    //* server, when listening
+    QLocalServer* server_ = nullptr;
+
+    //* socket connected to peer
+    QLocalSocket* socket_ = nullptr;
+
+    //* true when peer manifest has been received
+    bool manifestReceived_ = false;
+
+    //* peer logbook identity, from its manifest
+    QString peerLogbook_;
+
+    //* content hash key of entries known by peer, by identifier
+    QHash<quint64, quint64> peerEntries_;
+
+};
+
+#endif
@@ -19,22 +19,167 @@
 
 #include "LogEntry.h"
 #include "Attachment.h"
+#include "BodyStore.h"
 #include "ColorMenu.h"
 #include "Debug.h"
 #include "Logbook.h"
+#include "Snapshot.h"
 #include "TextFormat.h"
 #include "XmlColor.h"
 #include "XmlDef.h"
+#include "XmlStreamUtil.h"
 #include "XmlTextFormatBlock.h"
 #include "XmlTimeStamp.h"
 
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QStringList>
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+
+    namespace Local
+    {
+
+        //__________________________________
+        //* true if text format differs from default and must be saved
+        bool isSaved( const TextFormat::Block& format )
+        {
+            return !format.isEmpty() && (
+                (format.foreground().isValid() && format.foreground() != QPalette().color( QPalette::Text ) )
+                || (format.background().isValid() && format.background() != QPalette().color( QPalette::Base ) )
+                || format.format() != TextFormat::Default );
+        }
+
+        //__________________________________
+        //* write text and formats to data stream
+        void writeBody( QDataStream& stream, const QString& text, const TextFormat::Block::List& formats )
+        {
+            stream << text << quint32( formats.size() );
+            for( const auto& format:formats )
+            {
+                stream
+                    << qint32( format.begin() )
+                    << qint32( format.end() )
+                    << quint32( format.format() )
+                    << format.foreground()
+                    << format.background()
+                    << format.href();
+            }
+        }
+
+        //__________________________________
+        //* read text and formats from data stream
+        void readBody( QDataStream& stream, QString& text, TextFormat::Block::List& formats )
+        {
+            quint32 formatCount( 0 );
+            stream >> text >> formatCount;
+
+            formats.clear();
+            for( quint32 index = 0; index < formatCount && stream.status() == QDataStream::Ok; ++index )
+            {
+                qint32 begin( 0 );
+                qint32 end( 0 );
+                quint32 flags( 0 );
+                QColor foreground;
+                QColor background;
+                QString href;
+                stream >> begin >> end >> flags >> foreground >> background >> href;
+
+                TextFormat::Block format( begin, end, TextFormat::Flags( flags ) );
+                if( foreground.isValid() ) format.setForeground( foreground );
+                if( background.isValid() ) format.setBackground( background );
+                if( !href.isEmpty() ) format.setHRef( href );
+                formats.append( format );
+            }
+        }
+
+        //__________________________________
+        //* stable 64 bits hash of data written to stream by function
+        /** data stream setup is fixed, so that hashes can be stored and compared across sessions */
+        template<class Function>
+        quint64 hash( Function function )
+        {
+            QByteArray data;
+            QDataStream stream( &data, QIODevice::WriteOnly );
+            Snapshot::setup( stream );
+            function( stream );
+
+            const auto digest( QCryptographicHash::hash( data, QCryptographicHash::Md5 ) );
+            quint64 out( 0 );
+            for( int index = 0; index < 8; ++index )
+            { out = ( out << 8 ) | quint8( digest[index] ); }
+            return out;
+        }
+
+        //__________________________________
+        //* write content hash to data stream
+        void writeHash( QDataStream& stream, const LogEntry::ContentHash& hash )
+        { stream << hash.valid << hash.header << hash.text << hash.formats << hash.attachments; }
+
+        //__________________________________
+        //* read content hash from data stream
+        LogEntry::ContentHash readHash( QDataStream& stream )
+        {
+            LogEntry::ContentHash out;
+            stream >> out.valid >> out.header >> out.text >> out.formats >> out.attachments;
+            return out;
+        }
+
+    }
+
+}
 
 //__________________________________
 const QString LogEntry::MimeType = QStringLiteral("logbook/log-entry-list");
 
+//__________________________________
+LogEntry::Groups LogEntry::ContentHash::differences( const ContentHash& other ) const
+{
+    if( !( valid && other.valid ) ) return AllGroups;
+
+    Groups out( 0 );
+    if( header != other.header ) out |= HeaderGroup;
+    if( text != other.text ) out |= TextGroup;
+    if( formats != other.formats ) out |= FormatsGroup;
+    if( attachments != other.attachments ) out |= AttachmentsGroup;
+    return out;
+}
+
+//__________________________________
+QString LogEntry::ContentHash::toString() const
+{
+    if( !valid ) return QString();
+    return QStringLiteral( "%1:%2:%3:%4" )
+        .arg( header, 16, 16, QLatin1Char( '0' ) )
+        .arg( text, 16, 16, QLatin1Char( '0' ) )
+        .arg( formats, 16, 16, QLatin1Char( '0' ) )
+        .arg( attachments, 16, 16, QLatin1Char( '0' ) );
+}
+
+//__________________________________
+LogEntry::ContentHash LogEntry::ContentHash::fromString( const QString& value )
+{
+    ContentHash out;
+    const auto values( value.split( QLatin1Char( ':' ) ) );
+    if( values.size() != 4 ) return out;
+
+    bool valid[4] = { false, false, false, false };
+    out.header = values[0].toULongLong( &valid[0], 16 );
+    out.text = values[1].toULongLong( &valid[1], 16 );
+    out.formats = values[2].toULongLong( &valid[2], 16 );
+    out.attachments = values[3].toULongLong( &valid[3], 16 );
+    out.valid = std::all_of( std::begin( valid ), std::end( valid ), []( bool value ) { return value; } );
+    return out;
+}
+
 //__________________________________
 LogEntry::LogEntry():
     Counter( QStringLiteral("LogEntry") ),
+    id_( generateId() ),
     creation_( TimeStamp::now() ),
     modification_( TimeStamp::now() )
 {}
@@ -56,9 +201,11 @@ LogEntry::LogEntry( const QDomElement& element ):
         if( name == Xml::Title ) setTitle( value );
         else if( name == Xml::Keyword ) addKeyword( Keyword( value ) );
         else if( name == Xml::Author ) setAuthor( value );
+        else if( name == Xml::Id ) id_ = value.toULongLong( nullptr, 16 );
         else if( name == Xml::Creation ) setCreation( TimeStamp( static_cast<time_t>(value.toLong()) ) );
         else if( name == Xml::Modification ) setModification( TimeStamp( static_cast<time_t>(value.toLong()) ) );
         else if( name == Xml::Color ) setColor( QColor( value ) );
+        else if( name == Xml::BaseHash ) baseHash_ = ContentHash::fromString( value );
     }
 
     // parse children elements
@@ -83,9 +230,134 @@ LogEntry::LogEntry( const QDomElement& element ):
 
 }
 
+//_________________________________________________
+LogEntry::LogEntry( QXmlStreamReader& reader ):
+    Counter( QStringLiteral("LogEntry") ),
+    creation_( TimeStamp::now() ),
+    modification_( TimeStamp::now() )
+{
+    // parse attributes
+    for( const auto& attribute:reader.attributes() )
+    {
+        const auto name( attribute.name() );
+        const auto value( attribute.value().toString() );
+        if( name == Xml::Title ) setTitle( value );
+        else if( name == Xml::Keyword ) addKeyword( Keyword( value ) );
+        else if( name == Xml::Author ) setAuthor( value );
+        else if( name == Xml::Id ) id_ = value.toULongLong( nullptr, 16 );
+        else if( name == Xml::Creation ) setCreation( TimeStamp( static_cast<time_t>(value.toLong()) ) );
+        else if( name == Xml::Modification ) setModification( TimeStamp( static_cast<time_t>(value.toLong()) ) );
+        else if( name == Xml::Color ) setColor( QColor( value ) );
+        else if( name == Xml::BaseHash ) baseHash_ = ContentHash::fromString( value );
+    }
+
+    // parse children elements
+    /* time stamps, colors and text formats are small leaf elements, parsed through a detached dom element */
+    QDomDocument document;
+    while( reader.readNextStartElement() )
+    {
+        const auto tagName( reader.name() );
+        if( tagName == Xml::Keyword ) addKeyword( Keyword( reader ) );
+        else if( tagName == Base::Xml::Color ) {
+
+            XmlColor color( XmlStreamUtil::readElement( reader, document ) );
+            if( color.isValid() ) setColor( color );
+
+        } else if( tagName == Xml::Text ) setText( reader.readElementText( QXmlStreamReader::IncludeChildElements ) );
+        else if( tagName == Xml::Creation ) setCreation( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == Xml::Modification ) setModification( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == TextFormat::Xml::Tag ) addFormat( TextFormat::XmlBlock( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == Xml::Attachment ) Base::Key::associate( this, new Attachment( reader ) );
+        else reader.skipCurrentElement();
+    }
+
+}
+
+//_________________________________________________
+LogEntry::LogEntry( QDataStream& stream, bool loadBody ):
+    Counter( QStringLiteral("LogEntry") ),
+    creation_( TimeStamp::now() ),
+    modification_( TimeStamp::now() )
+{
+
+    stream >> id_;
+
+    // invalid time stamps are skipped, consistently with xml
+    const auto creation( Snapshot::readTimeStamp( stream ) );
+    if( creation.isValid() ) setCreation( creation );
+
+    const auto modification( Snapshot::readTimeStamp( stream ) );
+    if( modification.isValid() ) setModification( modification );
+
+    QString title;
+    QString author;
+    QColor color;
+    stream >> title >> author >> color;
+    setTitle( title );
+    setAuthor( author );
+    if( color.isValid() ) setColor( color );
+
+    // keywords
+    quint32 keywordCount( 0 );
+    stream >> keywordCount;
+    for( quint32 index = 0; index < keywordCount && stream.status() == QDataStream::Ok; ++index )
+    {
+        QString keyword;
+        stream >> keyword;
+        addKeyword( Keyword( keyword ) );
+    }
+
+    // text and formats
+    /* when not loaded, the serialized body is moved as is to the body store */
+    QByteArray body;
+    stream >> body;
+    if( !loadBody ) bodyStored_ = BodyStore::get().write( this, body );
+
+    if( bodyStored_ )
+    {
+        bodyLoaded_ = false;
+        bodySize_ = body.size();
+        _updateSize();
+    } else {
+
+        QDataStream bodyStream( body );
+        Snapshot::setup( bodyStream );
+
+        TextFormat::Block::List formats;
+        Local::readBody( bodyStream, text_, formats );
+        for( const auto& format:formats )
+        { addFormat( format ); }
+
+        bodySize_ = _bodySize();
+        _updateSize();
+
+        // body is tracked for memory budget, same as when loaded from store
+        BodyStore::get().touch( this, bodySize_, BodyStore::Access::Update );
+
+    }
+
+    // attachments
+    quint32 attachmentCount( 0 );
+    stream >> attachmentCount;
+    for( quint32 index = 0; index < attachmentCount && stream.status() == QDataStream::Ok; ++index )
+    { Base::Key::associate( this, new Attachment( stream ) ); }
+
+    // hashes, read last since all modifiers above invalidate the content hash
+    contentHash_ = Local::readHash( stream );
+    baseHash_ = Local::readHash( stream );
+
+}
+
 //__________________________________
 LogEntry::~LogEntry()
 {
+    BodyStore::get().remove( this );
+    BodyStore::get().release( this );
+
+    // disassociate from logbooks, for their cached entries to be updated
+    for( const auto& logbook:Base::KeySet<Logbook>( this ) )
+    { logbook->removeEntry( this ); }
+
     // delete associated attachments
     for( const auto& attachment:Base::KeySet<Attachment>( this ) )
     { delete attachment; }
@@ -95,13 +367,16 @@ LogEntry::~LogEntry()
 QDomElement LogEntry::domElement( QDomDocument& document ) const
 {
     Debug::Throw( QStringLiteral("LogEntry::domElement.\n") );
+    _loadBody();
     auto out( document.createElement( Xml::Entry ) );
 
     // title and author
     if( !title_.isEmpty() ) out.setAttribute( Xml::Title, title_ );
     if( !author_.isEmpty() ) out.setAttribute( Xml::Author, author_ );
+    if( id_ ) out.setAttribute( Xml::Id, QString::number( id_, 16 ) );
     if( creation_.isValid() ) out.setAttribute( Xml::Creation, QString::number( creation_.unixTime() ) );
     if( modification_.isValid() ) out.setAttribute( Xml::Modification, QString::number( modification_.unixTime() ) );
+    if( baseHash_.valid ) out.setAttribute( Xml::BaseHash, baseHash_.toString() );
 
     if( color_.isValid() )
     {
@@ -136,10 +411,7 @@ QDomElement LogEntry::domElement( QDomDocument& document ) const
     // dump text format
     for( const auto& format:formats_ )
     {
-        if( !format.isEmpty() && (
-            (format.foreground().isValid() && format.foreground() != QPalette().color( QPalette::Text ) )
-            || (format.background().isValid() && format.background() != QPalette().color( QPalette::Base ) )
-            || format.format() != TextFormat::Default ) )
+        if( Local::isSaved( format ) )
         { out.appendChild( TextFormat::XmlBlock( format ).domElement( document ) ); }
      }
 
@@ -151,26 +423,149 @@ QDomElement LogEntry::domElement( QDomDocument& document ) const
 
 }
 
+//__________________________________
+void LogEntry::writeXml( QXmlStreamWriter& writer ) const
+{
+    Debug::Throw( QStringLiteral("LogEntry::writeXml.\n") );
+    _loadBody();
+    writer.writeStartElement( Xml::Entry );
+
+    // attributes must all be written before child elements
+    if( !title_.isEmpty() ) writer.writeAttribute( Xml::Title, title_ );
+    if( !author_.isEmpty() ) writer.writeAttribute( Xml::Author, author_ );
+    if( id_ ) writer.writeAttribute( Xml::Id, QString::number( id_, 16 ) );
+    if( creation_.isValid() ) writer.writeAttribute( Xml::Creation, QString::number( creation_.unixTime() ) );
+    if( modification_.isValid() ) writer.writeAttribute( Xml::Modification, QString::number( modification_.unixTime() ) );
+    if( baseHash_.valid ) writer.writeAttribute( Xml::BaseHash, baseHash_.toString() );
+
+    // opaque color is written as attribute, translucent as child
+    const bool hasColor( color_.isValid() );
+    if( hasColor && color_.get().alpha() == 255 ) writer.writeAttribute( Xml::Color, color_.get().name() );
+
+    // single keyword is written as attribute
+    const bool singleKeyword( keywords_.size() == 1 && !keywords_.begin()->get().isEmpty() );
+    if( singleKeyword ) writer.writeAttribute( Xml::Keyword, keywords_.begin()->get() );
+
+    // translucent color
+    QDomDocument document;
+    if( hasColor && color_.get().alpha() != 255 )
+    { XmlStreamUtil::writeElement( writer, XmlColor( color_ ).domElement( document ) ); }
+
+    // keywords
+    if( !singleKeyword )
+    {
+        for( const auto& keyword:keywords_ )
+        { if( !keyword.get().isEmpty() ) keyword.writeXml( writer ); }
+    }
+
+    // dump text
+    if( !text_.isEmpty() )
+    {
+        QString text( text_ );
+        if( !text.endsWith('\n') ) text+='\n';
+        writer.writeTextElement( Xml::Text, text );
+    }
+
+    // dump text format
+    for( const auto& format:formats_ )
+    {
+        if( Local::isSaved( format ) )
+        { XmlStreamUtil::writeElement( writer, TextFormat::XmlBlock( format ).domElement( document ) ); }
+     }
+
+    // dump attachments
+    for( const auto& attachment:Base::KeySet<Attachment>( this ) )
+    { attachment->writeXml( writer ); }
+
+    writer.writeEndElement();
+
+}
+
+//__________________________________
+void LogEntry::writeSnapshot( QDataStream& stream ) const
+{
+    Debug::Throw( QStringLiteral("LogEntry::writeSnapshot.\n") );
+
+    stream << id_;
+    Snapshot::writeTimeStamp( stream, creation_ );
+    Snapshot::writeTimeStamp( stream, modification_ );
+    stream << title_ << author_ << ( color_.isValid() ? color_.get():QColor() );
+
+    // keywords
+    Keyword::List keywords;
+    for( const auto& keyword:keywords_ )
+    { if( !keyword.get().isEmpty() ) keywords.append( keyword ); }
+
+    stream << quint32( keywords.size() );
+    for( const auto& keyword:keywords )
+    { stream << keyword.get(); }
+
+    // text and formats
+    _loadBody();
+
+    QString text( text_ );
+    if( !text.isEmpty() && !text.endsWith('\n') ) text += '\n';
+
+    TextFormat::Block::List formats;
+    std::copy_if( formats_.begin(), formats_.end(), std::back_inserter( formats ), Local::isSaved );
+
+    QByteArray body;
+    QDataStream bodyStream( &body, QIODevice::WriteOnly );
+    Snapshot::setup( bodyStream );
+    Local::writeBody( bodyStream, text, formats );
+    stream << body;
+
+    // attachments
+    const Base::KeySet<Attachment> attachments( this );
+    stream << quint32( attachments.size() );
+    for( const auto& attachment:attachments )
+    { attachment->writeSnapshot( stream ); }
+
+    // hashes
+    Local::writeHash( stream, contentHash() );
+    Local::writeHash( stream, baseHash_ );
+
+}
+
+//__________________________________
+quint64 LogEntry::generateId()
+{ return ( QRandomGenerator::global()->generate64() & ~LegacyIdFlag ) | GeneratedIdMask; }
+
 //__________________________________
 LogEntry* LogEntry::copy() const
 {
     Debug::Throw( QStringLiteral("LogEntry::copy.\n") );
 
     auto *out( new LogEntry( *this ) );
+    out->setDirty( true );
+
+    // stored text and formats are released with each entry, and must be copied
+    auto& store( BodyStore::get() );
+    out->bodyStored_ = false;
+    if( !bodyLoaded_ )
+    {
+        const auto body( store.read( this ) );
+        out->bodyStored_ = store.write( out, body );
+        if( !out->bodyStored_ )
+        {
+            // keep in memory on error
+            QDataStream stream( body );
+            Snapshot::setup( stream );
+            Local::readBody( stream, out->text_, out->formats_ );
+            out->bodyLoaded_ = true;
+        }
+    }
+
+    if( out->bodyLoaded_ ) store.touch( out, out->_bodySize(), BodyStore::Access::Update );
 
     // clear associations
     out->clearAssociations();
 
     // copy all Attachments
-    for( const auto& attachment:Base::KeySet<Attachment>( this ) )
-    {
-
-        // copy attachment, associate to entry
-        Attachment *copy( new Attachment( *attachment ) );
-        copy->clearAssociations();
-        Base::Key::associate( copy, out );
+    out->_copyAttachments( *this );
 
-    }
+    // content is identical
+    out->contentHash_ = contentHash_;
 
     return out;
 }
@@ -194,7 +589,7 @@ bool LogEntry::matchKeyword( const QString &buffer ) const
 
 //__________________________________
 bool LogEntry::matchText(  const QString &buffer ) const
-{ return text_.contains( buffer, _caseSensitive() ); }
+{ return text().contains( buffer, _caseSensitive() ); }
 
 //__________________________________
 bool LogEntry::matchColor( const QString &buffer ) const
@@ -218,17 +613,31 @@ bool LogEntry::matchAttachment( QString buffer ) const
 
 //__________________________________
 void LogEntry::setModified()
-{ modification_ = TimeStamp::now(); }
+{
+    modification_ = TimeStamp::now();
+    setDirty( true );
+}
 
 //__________________________________
 void LogEntry::clearKeywords()
-{ keywords_.clear(); }
+{
+    for( const auto& keyword:keywords_ )
+    { _keywordRemoved( keyword ); }
+
+    keywords_.clear();
+    _updateSize();
+    setDirty( true );
+}
 
 //__________________________________
 void LogEntry::addKeyword( const Keyword &keyword )
 {
     if( !keywords_.contains( keyword ) && !keyword.get().isEmpty() )
-    { keywords_.insert( keyword ); }
+    {
+        keywords_.insert( keyword );
+        _keywordAdded( keyword );
+        setDirty( true );
+    }
 }
 
 //__________________________________
@@ -237,8 +646,14 @@ void LogEntry::replaceKeyword( const Keyword &oldKeyword, const Keyword &newKeyw
     if( keywords_.contains( oldKeyword ) )
     {
         keywords_.remove( oldKeyword );
-        if( !newKeyword.get().isEmpty() )
-        { keywords_.insert( newKeyword ); }
+        _keywordRemoved( oldKeyword );
+        if( !newKeyword.get().isEmpty() && !keywords_.contains( newKeyword ) )
+        {
+            keywords_.insert( newKeyword );
+            _keywordAdded( newKeyword );
+        }
+
+        setDirty( true );
 
     } else {
 
@@ -249,7 +664,31 @@ void LogEntry::replaceKeyword( const Keyword &oldKeyword, const Keyword &newKeyw
 
 //__________________________________
 void LogEntry::removeKeyword( const Keyword &keyword )
-{ keywords_.remove( keyword ); }
+{
+    if( keywords_.remove( keyword ) )
+    {
+        _keywordRemoved( keyword );
+        setDirty( true );
+    }
+}
+
+//__________________________________
+void LogEntry::_keywordAdded( const Keyword& keyword )
+{
+    for( const auto& logbook:Base::KeySet<Logbook>( this ) )
+    { logbook->addEntryKeyword( this, keyword ); }
+
+    _updateSize();
+}
+
+//__________________________________
+void LogEntry::_keywordRemoved( const Keyword& keyword )
+{
+    for( const auto& logbook:Base::KeySet<Logbook>( this ) )
+    { logbook->removeEntryKeyword( this, keyword ); }
+
+    _updateSize();
+}
 
 //__________________________________
 void LogEntry::addFormat( TextFormat::Block format )
@@ -258,9 +697,245 @@ void LogEntry::addFormat( TextFormat::Block format )
     if( format.foreground() == Qt::black ) format.unsetForeground();
     if( format.background() == Qt::black ) format.unsetBackground();
     if( format.format() == TextFormat::Default && !format.foreground().isValid() && !format.background().isValid() ) return;
+
+    _loadBody();
     formats_.append(format);
+    _updateBody();
+}
+
+//__________________________________
+void LogEntry::setFormats( const TextFormat::Block::List& formats )
+{
+    _loadBody();
+    formats_ = formats;
+    _updateBody();
+}
+
+//__________________________________
+void LogEntry::setText( const QString& text )
+{
+    _loadBody();
+    text_ = text;
+    _updateBody();
+}
+
+//__________________________________
+void LogEntry::merge( const LogEntry& other, Groups groups )
+{
+    Debug::Throw( QStringLiteral("LogEntry::merge.\n") );
+
+    if( groups & HeaderGroup )
+    {
+        setTitle( other.title_ );
+        setAuthor( other.author_ );
+        setColor( other.color_.isValid() ? other.color_.get():QColor() );
+
+        for( const auto& keyword:keywords_ )
+        { _keywordRemoved( keyword ); }
+
+        keywords_ = other.keywords_;
+        for( const auto& keyword:keywords_ )
+        { _keywordAdded( keyword ); }
+
+        _updateSize();
+        setDirty( true );
+    }
+
+    /*
+    other entry text and formats are copied before being set,
+    since loading this entry body might evict the other one, invalidating references
+    */
+    if( groups & TextGroup )
+    {
+        const QString text( other.text() );
+        setText( text );
+    }
+
+    if( groups & FormatsGroup )
+    {
+        const TextFormat::Block::List formats( other.formats() );
+        setFormats( formats );
+    }
+
+    if( groups & AttachmentsGroup )
+    {
+        for( const auto& attachment:Base::KeySet<Attachment>( this ) )
+        { delete attachment; }
+
+        _copyAttachments( other );
+        setDirty( true );
+    }
+
+    if( modification_ < other.modification_ ) setModification( other.modification_ );
+
+}
+
+//__________________________________
+bool LogEntry::unloadBody() const
+{
+
+    if( !bodyLoaded_ ) return true;
+
+    // hashes are computed while text and formats are in memory, for summaries to never reload them
+    if( !contentHash_.valid ) _updateContentHash();
+
+    // store body, unless already stored and unchanged since
+    if( !bodyStored_ )
+    {
+        bodyStored_ = BodyStore::get().write( this, _body() );
+        if( !bodyStored_ ) return false;
+    }
+
+    text_ = QString();
+    formats_ = TextFormat::Block::List();
+    bodyLoaded_ = false;
+    BodyStore::get().remove( this );
+    return true;
+
 }
 
 //________________________________________________________
 Qt::CaseSensitivity LogEntry::_caseSensitive() const
 { return XmlOptions::get().get<bool>( QStringLiteral("CASE_SENSITIVE") ) ? Qt::CaseSensitive: Qt::CaseInsensitive; }
+
+//________________________________________________________
+void LogEntry::_loadBody() const
+{
+
+    auto& store( BodyStore::get() );
+    if( bodyLoaded_ )
+    {
+        store.touch( this, _bodySize(), BodyStore::Access::Hit );
+        return;
+    }
+
+    bodyLoaded_ = true;
+    const auto body( store.read( this ) );
+    if( body.isEmpty() )
+    {
+        Debug::Throw(0) << "LogEntry::_loadBody - unable to load text for entry " << title_ << Qt::endl;
+        return;
+    }
+
+    QDataStream stream( body );
+    Snapshot::setup( stream );
+    Local::readBody( stream, text_, formats_ );
+    store.touch( this, _bodySize(), BodyStore::Access::Miss );
+
+}
+
+//________________________________________________________
+const LogEntry::ContentHash& LogEntry::contentHash() const
+{
+
+    if( contentHash_.valid ) return contentHash_;
+    _loadBody();
+    _updateContentHash();
+    return contentHash_;
+
+}
+
+//________________________________________________________
+void LogEntry::_updateContentHash() const
+{
+
+    // header. Keywords are sorted, since their set is not ordered
+    QStringList keywords;
+    for( const auto& keyword:keywords_ )
+    { if( !keyword.get().isEmpty() ) keywords.append( keyword.get() ); }
+    keywords.sort();
+
+    contentHash_.header = Local::hash( [this, &keywords]( QDataStream& stream )
+        { stream << title_ << author_ << ( color_.isValid() ? color_.get():QColor() ) << keywords; } );
+
+    // text and formats are normalized the same way as when written
+    contentHash_.text = Local::hash( [this]( QDataStream& stream )
+        {
+            QString text( text_ );
+            if( !text.isEmpty() && !text.endsWith('\n') ) text += '\n';
+            stream << text;
+        } );
+
+    contentHash_.formats = Local::hash( [this]( QDataStream& stream )
+        {
+            TextFormat::Block::List formats;
+            std::copy_if( formats_.begin(), formats_.end(), std::back_inserter( formats ), Local::isSaved );
+            Local::writeBody( stream, QString(), formats );
+        } );
+
+    // attachments are sorted, since their set is not ordered
+    QList<QByteArray> attachments;
+    for( const auto& attachment:Base::KeySet<Attachment>( this ) )
+    {
+        QByteArray data;
+        QDataStream attachmentStream( &data, QIODevice::WriteOnly );
+        Snapshot::setup( attachmentStream );
+        attachment->writeSnapshot( attachmentStream );
+        attachments.append( data );
+    }
+    std::sort( attachments.begin(), attachments.end() );
+
+    contentHash_.attachments = Local::hash( [&attachments]( QDataStream& stream )
+        { for( const auto& attachment:attachments ) stream << attachment; } );
+
+    contentHash_.valid = true;
+
+}
+
+//________________________________________________________
+qint64 LogEntry::_bodySize() const
+{ return text_.size()*qint64( sizeof( QChar ) ) + formats_.size()*qint64( sizeof( TextFormat::Block ) ); }
+
+//________________________________________________________
+void LogEntry::_updateBody()
+{
+    setDirty( true );
+    if( bodyStored_ )
+    {
+        BodyStore::get().release( this );
+        bodyStored_ = false;
+    }
+
+    bodySize_ = _bodySize();
+    BodyStore::get().touch( this, bodySize_, BodyStore::Access::Update );
+    _updateSize();
+}
+
+//________________________________________________________
+void LogEntry::_updateSize()
+{
+    // keyword values are interned, and shared between entries
+    qint64 size( ( title_.size() + author_.size() )*qint64( sizeof( QChar ) ) );
+    size += keywords_.size()*qint64( sizeof( Keyword ) );
+    size += bodySize_;
+    if( size == size_ ) return;
+
+    const auto delta( size - size_ );
+    size_ = size;
+    for( const auto& logbook:Base::KeySet<Logbook>( this ) )
+    { logbook->updateEntrySize( this, delta ); }
+}
+
+//________________________________________________________
+void LogEntry::_copyAttachments( const LogEntry& other )
+{
+    for( const auto& attachment:Base::KeySet<Attachment>( &other ) )
+    {
+
+        // copy attachment, associate to entry
+        Attachment *copy( new Attachment( *attachment ) );
+        copy->clearAssociations();
+        Base::Key::associate( copy, this );
+
+    }
+}
+
+//________________________________________________________
+QByteArray LogEntry::_body() const
+{
+    QByteArray out;
+    QDataStream stream( &out, QIODevice::WriteOnly );
+    Snapshot::setup( stream );
+    Local::writeBody( stream, text_, formats_ );
+    return out;
+}
@@ -29,8 +29,11 @@
 #include "TimeStamp.h"
 #include "XmlOptions.h"
 
+#include <QDataStream>
 #include <QDomElement>
 #include <QDomDocument>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 //* log file entry manipulation object
 class LogEntry:private Base::Counter<LogEntry>, public Base::Key
@@ -54,12 +57,81 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
 
     using Mask = Base::underlying_type_t<MaskFlag>;
 
+    //* field groups, compared and merged independently when synchronizing
+    enum GroupFlag
+    {
+        HeaderGroup = 1<<0,
+        TextGroup = 1<<1,
+        FormatsGroup = 1<<2,
+        AttachmentsGroup = 1<<3,
+        AllGroups = HeaderGroup | TextGroup | FormatsGroup | AttachmentsGroup
+    };
+
+    using Groups = Base::underlying_type_t<GroupFlag>;
+
+    //* content hashes, one per field group
+    /**
+    header covers title, author, color and keywords.
+    Creation and modification time stamps are not part of the content
+    */
+    class ContentHash
+    {
+        public:
+
+        //* equal to operator
+        bool operator == ( const ContentHash& other ) const
+        {
+            return
+                valid == other.valid &&
+                header == other.header &&
+                text == other.text &&
+                formats == other.formats &&
+                attachments == other.attachments;
+        }
+
+        //* different from operator
+        bool operator != ( const ContentHash& other ) const
+        { return !( *this == other ); }
+
+        //* groups which hashes differ. All groups differ if any hash is invalid
+        Groups differences( const ContentHash& ) const;
+
+        //* string representation, used for xml
+        QString toString() const;
+
+        //* construct from string representation. Hash is invalid on error
+        static ContentHash fromString( const QString& );
+
+        //* true if hashes are set
+        bool valid = false;
+
+        //* header hash
+        quint64 header = 0;
+
+        //* text hash
+        quint64 text = 0;
+
+        //* formats hash
+        quint64 formats = 0;
+
+        //* attachments hash
+        quint64 attachments = 0;
+
+    };
+
     //* empty creator
     explicit LogEntry();
 
     //* constructor from DOM
     explicit LogEntry( const QDomElement& );
 
+    //* constructor from xml stream
+    explicit LogEntry( QXmlStreamReader& );
+
+    //* constructor from binary snapshot
+    /** when loadBody is false, text and formats are moved to body store, and loaded on demand */
+    explicit LogEntry( QDataStream&, bool loadBody = true );
+
     //* destructor
     ~LogEntry() override;
 
@@ -76,10 +148,61 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     //* DomElement
     QDomElement domElement( QDomDocument& ) const;
 
+    //* write to xml stream
+    void writeXml( QXmlStreamWriter& ) const;
+
+    //* write to binary snapshot
+    /** content is normalized the same way as when writing to xml, so that both are read back identically */
+    void writeSnapshot( QDataStream& ) const;
+
     //* return a new entry copy from this
     /* deep copy of the associated attachments is performed */
     LogEntry* copy() const;
 
+    //* identifier
+    /**
+    it is generated when the entry is created and persisted with the entry.
+    Entries saved before identifiers were introduced are assigned one when added to a logbook.
+    Until then, it is derived from the creation time stamp
+    */
+    quint64 id() const
+    { return id_ ? id_:derivedId( creation_ ); }
+
+    //* true if entry has an identifier, either generated or assigned
+    bool hasId() const
+    { return id_; }
+
+    //* new generated identifier
+    static quint64 generateId();
+
+    //* true if identifier is generated or assigned, rather than derived from creation time stamp
+    static bool isGeneratedId( quint64 id )
+    { return id & GeneratedIdMask; }
+
+    //* maximum number of legacy identifiers assigned within the same second
+    static constexpr int LegacyIdCount = 1<<8;
+
+    //* identifier assigned to entries saved before identifiers were introduced
+    /**
+    it only depends on the creation time stamp, and on an index disambiguating entries created within the same second.
+    Header and text are not used, since they might be modified on one copy of the logbook before it is upgraded
+    */
+    static quint64 legacyId( const TimeStamp& timeStamp, int index )
+    { return GeneratedIdMask | LegacyIdFlag | ( ( quint64( timeStamp.unixTime() ) & LegacyTimeMask ) << 8 ) | quint64( index & ( LegacyIdCount-1 ) ); }
+
+    //* true if identifier was assigned to an entry saved before identifiers were introduced
+    static bool isLegacyId( quint64 id )
+    { return ( id & ( GeneratedIdMask | LegacyIdFlag ) ) == ( GeneratedIdMask | LegacyIdFlag ); }
+
+    //* legacy identifier with given index, and same creation time as given one
+    static quint64 siblingLegacyId( quint64 id, int index )
+    { return ( id & ~quint64( LegacyIdCount-1 ) ) | quint64( index & ( LegacyIdCount-1 ) ); }
+
+    //* identifier derived from creation time stamp
+    /** derived identifiers never have the most significant bit set, so that they cannot collide with generated ones */
+    static quint64 derivedId( const TimeStamp& timeStamp )
+    { return quint64( timeStamp.unixTime() ) & ~GeneratedIdMask; }
+
     //* creation TimeStamp
     const TimeStamp& creation() const
     { return creation_; }
@@ -109,12 +232,54 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     { return color_; }
 
     //* entry text format
+    /**
+    it is loaded from body store if needed.
+    The reference is invalidated by any body access to another entry, which might evict this one
+    */
     const TextFormat::Block::List& formats() const
-    { return formats_; }
+    {
+        _loadBody();
+        return formats_;
+    }
 
     //* LogEntry text
+    /**
+    it is loaded from body store if needed.
+    The reference is invalidated by any body access to another entry, which might evict this one
+    */
     const QString& text() const
-    { return text_; }
+    {
+        _loadBody();
+        return text_;
+    }
+
+    //* true if text and formats are in memory
+    bool isBodyLoaded() const
+    { return bodyLoaded_; }
+
+    //* approximate size of entry content, in bytes
+    /** it is cached, and updated whenever the entry is modified. Text and formats are never loaded */
+    qint64 approximateSize() const
+    { return size_; }
+
+    //* content hashes
+    /**
+    they are cached until the entry is modified, and computed before text and formats are unloaded.
+    Text and formats are only loaded from body store for entries modified while unloaded
+    */
+    const ContentHash& contentHash() const;
+
+    //* content hashes at last synchronization, used as common base for merging
+    const ContentHash& baseHash() const
+    { return baseHash_; }
+
+    //* true if entry has been modified since it was last read or written
+    bool isDirty() const
+    { return dirty_; }
+
+    //* true if entry current content has been appended to the logbook journal
+    bool isJournaled() const
+    { return journaled_; }
 
 
     //* returns true if entry has at least one attachment
@@ -152,20 +317,38 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     //*@name modifiers
     //@{
 
+    //* identifier. Zero means derived from creation time stamp
+    void setId( quint64 id )
+    {
+        if( id == id_ ) return;
+        id_ = id;
+        setDirty( true );
+    }
+
     //* creation TimeStamp
     void setCreation( const TimeStamp &stamp )
-    { creation_ = stamp; }
+    {
+        creation_ = stamp;
+        setDirty( true );
+    }
 
     //* set modification_ to _now_
     void setModified();
 
     //* modification TimeStamp
     void setModification( const TimeStamp &stamp )
-    { modification_ = stamp; }
+    {
+        modification_ = stamp;
+        setDirty( true );
+    }
 
     //* Log entry title
     void setTitle( const QString &title )
-    { title_ = title; }
+    {
+        title_ = title;
+        _updateSize();
+        setDirty( true );
+    }
 
     //* clear keywords
     void clearKeywords();
@@ -181,22 +364,61 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
 
     //* Log entry author
     void setAuthor( const QString &author )
-    { author_ = author; }
+    {
+        author_ = author;
+        _updateSize();
+        setDirty( true );
+    }
 
     //* LogEntry color
     void setColor(  const QColor& color )
-    { color_ = Base::Color(color); }
+    {
+        color_ = Base::Color(color);
+        setDirty( true );
+    }
 
     //* add TextFormatBlock
     void addFormat( TextFormat::Block );
 
     //* entry text format
-    void setFormats( const TextFormat::Block::List& formats )
-    { formats_ = formats; }
+    void setFormats( const TextFormat::Block::List& );
 
     //* LogEntry text
-    void setText( const QString &text )
-    { text_ = text; }
+    void setText( const QString& );
+
+    //* content hashes at last synchronization
+    /** entry is marked dirty so that it gets written, but its content hashes are unchanged */
+    void setBaseHash( const ContentHash& hash )
+    {
+        if( hash == baseHash_ ) return;
+        baseHash_ = hash;
+        dirty_ = true;
+        journaled_ = false;
+    }
+
+    //* copy given field groups from other entry
+    /** modification time stamp is set to the most recent of both */
+    void merge( const LogEntry&, Groups );
+
+    //* move text and formats to body store, to free memory. They are reloaded on demand
+    /** returns true on success. It is const since it does not change the entry content */
+    bool unloadBody() const;
+
+    //* mark entry as modified since last read or written
+    /** it is set by all modifiers, and must be set explicitly when associated attachments change */
+    void setDirty( bool value )
+    {
+        dirty_ = value;
+        if( value )
+        {
+            journaled_ = false;
+            contentHash_.valid = false;
+        }
+    }
+
+    //* mark entry current content as appended to the logbook journal
+    void setJournaled( bool value )
+    { journaled_ = value; }
 
     //* set if entry is said visible by the find bar
     void setFindSelected( bool value )
@@ -217,8 +439,8 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     //* use to check if entries have same creation time
     using SameCreationFTor = Base::Functor::Unary<LogEntry, const TimeStamp&, &LogEntry::creation>;
 
-    //* use to check if entries have same creation and modification time
-    using DuplicateFTor = Base::Functor::Unary<LogEntry, const TimeStamp&, &LogEntry::creation>;
+    //* use to check if entries have same identifier
+    using DuplicateFTor = Base::Functor::Unary<LogEntry, quint64, &LogEntry::id>;
 
     /**
     used to check if LogEntry keyword matches a given keyword.
@@ -262,6 +484,45 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     //* case sensitivity
     Qt::CaseSensitivity _caseSensitive() const;
 
+    //* load text and formats from body store, if needed
+    void _loadBody() const;
+
+    //* serialized text and formats
+    QByteArray _body() const;
+
+    //* approximate memory size of text and formats
+    qint64 _bodySize() const;
+
+    //* mark text and formats as modified
+    void _updateBody();
+
+    //* compute content hashes from text and formats in memory
+    void _updateContentHash() const;
+
+    //* update cached size, and that of associated logbooks
+    void _updateSize();
+
+    //* associate copies of other entry attachments
+    void _copyAttachments( const LogEntry& );
+
+    //* update keyword index of associated logbooks
+    void _keywordAdded( const Keyword& );
+
+    //* update keyword index of associated logbooks
+    void _keywordRemoved( const Keyword& );
+
+    //* most significant bit, set for generated identifiers
+    static constexpr quint64 GeneratedIdMask = quint64(1)<<63;
+
+    //* second most significant bit, set for legacy identifiers only
+    static constexpr quint64 LegacyIdFlag = quint64(1)<<62;
+
+    //* creation time bits used in legacy identifiers
+    static constexpr quint64 LegacyTimeMask = ( quint64(1)<<54 ) - 1;
+
+    //* log entry identifier. Zero if derived from creation time
+    quint64 id_ = 0;
+
     //* log entry creation time
     TimeStamp creation_;
 
@@ -278,7 +539,8 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     QString author_;
 
     //* LogEntry text
-    QString text_;
+    /** it is mutable because it is loaded on demand */
+    mutable QString text_;
 
     //* LogEntry color
     Base::Color color_;
@@ -290,7 +552,32 @@ class LogEntry:private Base::Counter<LogEntry>, public Base::Key
     bool keywordSelected_ = false;
 
     //* list of text formats
-    TextFormat::Block::List formats_;
+    /** it is mutable because it is loaded on demand */
+    mutable TextFormat::Block::List formats_;
+
+    //* true if entry has been modified since last read or written
+    bool dirty_ = true;
+
+    //* true if entry current content has been appended to the logbook journal
+    bool journaled_ = false;
+
+    //* true if text and formats are in memory
+    mutable bool bodyLoaded_ = true;
+
+    //* true if text and formats are held by the body store. They are released whenever modified
+    mutable bool bodyStored_ = false;
+
+    //* approximate size of text and formats, at last modification
+    qint64 bodySize_ = 0;
+
+    //* cached approximate size, as accounted for by associated logbooks
+    qint64 size_ = 0;
+
+    //* cached content hashes. They are invalidated whenever the entry is modified
+    mutable ContentHash contentHash_;
+
+    //* content hashes at last synchronization
+    ContentHash baseHash_;
 
 };
 
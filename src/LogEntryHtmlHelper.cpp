@@ -155,7 +155,7 @@ void LogEntryHtmlHelper::_appendHeader( QDomDocument& document, QDomElement& par
             appendChild( document.createElement( QStringLiteral("td") ) ).
             appendChild( document.createElement( QStringLiteral("a") ) ).
             toElement();
-        ref.setAttribute( QStringLiteral("name"), QString::number( entry_->creation().unixTime() ) );
+        ref.setAttribute( QStringLiteral("name"), QString::number( entry_->id(), 16 ) );
         ref.appendChild( document.createTextNode( entry_->title().toUtf8() ) );
     }
 
@@ -21,19 +21,34 @@
 #include "Attachment.h"
 #include "CppUtil.h"
 #include "Debug.h"
+#include "DeflateDevice.h"
 #include "FileCheck.h"
+#include "FileFormat.h"
+#include "FileSync.h"
+#include "Journal.h"
 #include "LogEntry.h"
+#include "Snapshot.h"
 #include "Util.h"
 #include "XmlDef.h"
 #include "XmlOptions.h"
+#include "XmlStreamUtil.h"
 #include "XmlTimeStamp.h"
 
 
 #include <QDomDocument>
+#include <QBuffer>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QFuture>
 #include <QTextStream>
+#include <QThread>
+#include <QtConcurrentRun>
+#include <QXmlStreamWriter>
 
-#include <new>
+#include <algorithm>
+#include <bitset>
 
 namespace
 {
@@ -41,21 +56,107 @@ namespace
     namespace Local
     {
 
+        //* maximum size of serialized content pending compression and write, when writing in parallel
+        static const qint64 maxPendingSize = 64<<20;
+
         //________________________________________________________
-        QByteArray safeUncompress( const QByteArray& content )
+        //* compress content and write to file
+        /** this is safe to be called from worker threads */
+        bool writeContent( const File& file, const QByteArray& content, FileFormat::Codec codec )
+        {
+            QFile out( file );
+            if( !out.open( QIODevice::WriteOnly ) ) return false;
+
+            const auto data( FileFormat::encode( content, codec ) );
+            return out.write( data ) == data.size() && out.flush();
+        }
+
+        //______________________________________________________________________
+        //* temporary file, used to write given file
+        File temporaryFile( const File& file )
+        { return File( QStringLiteral( ".%1.new" ).arg( file.localName().get() ) ).addPath( file.path() ); }
+
+        //______________________________________________________________________
+        //* local entry matching remote entry with legacy identifier, created within the same second
+        /**
+        legacy identifiers might differ between copies of a logbook for entries created within the same second,
+        since they are disambiguated by read order. Candidates must not match any other remote entry,
+        and must have either the same header or the same text
+        */
+        LogEntry* legacyDuplicate( const EntryIndex& entries, const EntryIndex& remoteEntries, const LogEntry* entry )
         {
-            try
+            const auto& hash( entry->contentHash() );
+            LogEntry* out( nullptr );
+            int outDifferences( 0 );
+            for( int index = 0; index < LogEntry::LegacyIdCount; ++index )
             {
+                const auto id( LogEntry::siblingLegacyId( entry->id(), index ) );
+                const auto candidate( entries.find( id ) );
+                if( !candidate || remoteEntries.find( id ) ) continue;
+
+                const auto groups( candidate->contentHash().differences( hash ) );
+                if( ( groups & LogEntry::HeaderGroup ) && ( groups & LogEntry::TextGroup ) ) continue;
+
+                const int differences( std::bitset<8>( groups ).count() );
+                if( !out || differences < outDifferences )
+                {
+                    out = candidate;
+                    outDifferences = differences;
+                }
+            }
+
+            return out;
+        }
 
-                return qUncompress( content );
+        //______________________________________________________________________
+        //* 64 bits hash mixing
+        quint64 mix( quint64 value )
+        {
+            value += 0x9e3779b97f4a7c15ULL;
+            value = ( value ^ ( value >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+            value = ( value ^ ( value >> 27 ) ) * 0x94d049bb133111ebULL;
+            return value ^ ( value >> 31 );
+        }
 
-            } catch( std::bad_alloc& exception ) {
+        //______________________________________________________________________
+        //* entry hash, from identifier, time stamps, content and base hashes
+        quint64 entryHash( const LogEntry* entry )
+        {
+            const auto& content( entry->contentHash() );
+            const auto& base( entry->baseHash() );
+            quint64 out( mix( mix( mix( entry->id() ) ^ quint64( entry->creation().unixTime() ) ) ^ quint64( entry->modification().unixTime() ) ) );
+            for( const auto& value:{ content.header, content.text, content.formats, content.attachments, base.header, base.text, base.formats, base.attachments } )
+            { out = mix( out ^ value ); }
+            return out;
+        }
 
-                Debug::Throw() << "safeUncompress - caught bad_alloc exception: " << exception.what() << Qt::endl;
-                return QByteArray();
+        //______________________________________________________________________
+        //* update entry base hash, and mark its logbooks as modified if changed
+        void setBaseHash( LogEntry* entry, const LogEntry::ContentHash& hash )
+        {
+            if( entry->baseHash() == hash ) return;
+            entry->setBaseHash( hash );
+            for( const auto& logbook:Base::KeySet<Logbook>( entry ) )
+            { logbook->setModified( true ); }
+        }
 
-            }
+        //______________________________________________________________________
+        //* journal record used to remove entry
+        Journal::Record removeRecord( const LogEntry* entry )
+        {
+            Journal::Record record;
+            record.action = Journal::Action::Remove;
+            record.id = entry->id();
+            record.creation = entry->creation();
+            return record;
+        }
 
+        //______________________________________________________________________
+        //* month index, used for sharding
+        int month( const TimeStamp& timeStamp )
+        {
+            const auto date( QDateTime::fromSecsSinceEpoch( timeStamp.unixTime() ).date() );
+            return date.year()*12 + date.month() - 1;
         }
 
         //______________________________________________________________________
@@ -101,6 +202,16 @@ Logbook::Logbook( const File &file ):
     read();
 }
 
+//_________________________________
+Logbook::Sharding Logbook::Sharding::fromOptions()
+{
+    Sharding out;
+    out.maxEntries = XmlOptions::get().get<int>( QStringLiteral("SHARD_MAX_ENTRIES") );
+    out.maxSize = qint64( XmlOptions::get().get<int>( QStringLiteral("SHARD_MAX_SIZE") ) ) << 10;
+    out.byMonth = XmlOptions::get().get<bool>( QStringLiteral("SHARD_BY_MONTH") );
+    return out;
+}
+
 //_________________________________
 Logbook::~Logbook()
 {
@@ -109,6 +220,10 @@ Logbook::~Logbook()
     // delete associated entries
     Base::KeySet<LogEntry> entries( this );
     for( const auto& entry:entries ) delete entry;
+
+    // children might outlive this logbook
+    for( const auto& logbook:children_ )
+    { logbook->parent_ = nullptr; }
 }
 
 //_________________________________
@@ -120,146 +235,178 @@ void Logbook::setUseCompression( bool value )
 }
 
 //_________________________________
-bool Logbook::read()
+void Logbook::setCodec( FileFormat::Codec codec )
 {
+    codec_ = FileFormat::isSupported( codec ) ? codec:FileFormat::defaultCodec();
+    for( const auto& logbook:children_ )
+    { logbook->setCodec( codec ); }
+}
 
-    Debug::Throw( QStringLiteral("Logbook::read.\n") );
+//_________________________________
+void Logbook::setUseSnapshot( bool value )
+{
+    useSnapshot_ = value;
+    for( const auto& logbook:children_ )
+    { logbook->setUseSnapshot( value ); }
+}
 
-    if( file_.isEmpty() )
-    {
-        Debug::Throw( QStringLiteral("Logbook::read - file is empty.\n") );
-        return false;
-    }
+//_________________________________
+void Logbook::setLazyLoading( bool value )
+{
+    lazyLoading_ = value;
+    for( const auto& logbook:children_ )
+    { logbook->setLazyLoading( value ); }
+}
 
-    // check input file
-    if( !file_.exists() ) {
-        Debug::Throw(0) << "Logbook::read - ERROR: cannot access file \"" << file_ << "\".\n";
-        return false;
-    }
+//_________________________________
+void Logbook::setLoadedSince( const TimeStamp& value )
+{
+    loadedSince_ = value;
+    for( const auto& logbook:children_ )
+    { logbook->setLoadedSince( value ); }
+}
 
-    // delete associated entries
-    for( const auto& entry:this->entries() )
-    { delete entry; }
+//_________________________________
+void Logbook::setManifestOnly( bool value )
+{
+    manifestOnly_ = value;
+    for( const auto& logbook:children_ )
+    { logbook->setManifestOnly( value ); }
+}
+
+//_________________________________
+bool Logbook::hasUnloadedChildren() const
+{
+    return std::any_of( children_.begin(), children_.end(),
+        []( const LogbookPtr& logbook ) { return !logbook->loaded_ || logbook->hasUnloadedChildren(); } );
+}
 
-    // parse the file
-    QFile file( file_ );
-    if ( !file.open( QIODevice::ReadOnly ) )
+//_________________________________
+Keyword::Set Logbook::unloadedKeywords() const
+{
+    Keyword::Set out;
+    for( const auto& logbook:children_ )
     {
-        Debug::Throw(0, QStringLiteral("Logbook::read - cannot open file.\n") );
-        return false;
+        if( !logbook->loaded_ ) out.unite( logbook->summary_.keywords );
+        else out.unite( logbook->unloadedKeywords() );
     }
 
-    // read everything from file
-    // try read compressed and try uncompress
-    auto content( file.readAll() );
-    auto uncompressed( Local::safeUncompress( content ) );
-
-    // try read raw if failed
-    if( uncompressed.isEmpty() ) uncompressed = content;
-
-    // create document
-    QDomDocument document;
-    if( !document.setContent( uncompressed, error_ ) ) return false;
+    return out;
+}
 
-    // read first child
-    auto docElement = document.documentElement();
-    const auto tagName( docElement.tagName() );
-    if( tagName != Xml::Logbook )
+//_________________________________
+template<class Predicate>
+bool Logbook::_loadChildren( Predicate predicate )
+{
+    bool loaded( false );
+    for( const auto& logbook:children_ )
     {
-        Debug::Throw(0) << "Logbook::read - invalid tag name: " << tagName << Qt::endl;
-        return false;
+        if( logbook->loaded_ ) loaded |= logbook->_loadChildren( predicate );
+        else if( predicate( *logbook ) ) loaded |= logbook->_readUnloaded();
     }
 
-    // read attributes
-    const auto attributes( docElement.attributes() );
-    for( int i=0; i<attributes.count(); i++ )
-    {
+    return loaded;
+}
 
-        const auto attribute( attributes.item( i ).toAttr() );
-        if( attribute.isNull() ) continue;
-        QString name( attribute.name() );
-        QString value( attribute.value() );
+//_________________________________
+bool Logbook::loadChildren()
+{
+    Debug::Throw( QStringLiteral("Logbook::loadChildren.\n") );
+    return _loadChildren( []( const Logbook& ) { return true; } );
+}
 
-        if( name == Xml::Title ) setTitle( value );
-        else if( name == Xml::File ) setFile( File( value ) );
-        else if( name == Xml::ParentFile ) setParentFile( File( value ) );
-        else if( name == Xml::Directory ) setDirectory( File( value ) );
-        else if( name == Xml::Author ) setAuthor( value );
-        else if( name == Xml::SortMethod ) setSortMethod( (SortMethod) value.toInt() );
-        else if( name == Xml::SortOrder ) setSortOrder( value.toInt() );
-        else if( name == Xml::ReadOnly ) setReadOnly( value.toInt() );
-        else if( name == Xml::BackupMask ) setIsBackup( value.toInt() );
-        else if( name == Xml::Entries ) {
+//_________________________________
+bool Logbook::loadChildren( const Keyword& keyword )
+{
+    Debug::Throw( QStringLiteral("Logbook::loadChildren (keyword).\n") );
+    return _loadChildren( [&keyword]( const Logbook& logbook ) { return logbook.summary_.keywords.contains( keyword ); } );
+}
 
-            setXmlEntries( value.toInt() );
-            emit maximumProgressAvailable( value.toInt() );
+//_________________________________
+bool Logbook::loadChildren( const TimeStamp& timeStamp )
+{
+    Debug::Throw( QStringLiteral("Logbook::loadChildren (time stamp).\n") );
+    return _loadChildren( [&timeStamp]( const Logbook& logbook )
+        { return !( timeStamp < logbook.summary_.first || logbook.summary_.last < timeStamp ); } );
+}
 
-        } else if( name == Xml::Children ) setXmlChildren( value.toInt() );
-        else Debug::Throw(0) << "Logbook::read - unrecognized logbook attribute: \"" << name << "\"\n";
+//_________________________________
+bool Logbook::loadChildren( QList<TimeStamp> timeStamps )
+{
+    Debug::Throw( QStringLiteral("Logbook::loadChildren (time stamps).\n") );
+    if( timeStamps.empty() ) return false;
 
+    // time stamps are sorted once, for each child range to be checked with a binary search
+    std::sort( timeStamps.begin(), timeStamps.end() );
+    return _loadChildren( [&timeStamps]( const Logbook& logbook )
+        {
+            const auto iter( std::lower_bound( timeStamps.begin(), timeStamps.end(), logbook.summary_.first ) );
+            return iter != timeStamps.end() && !( logbook.summary_.last < *iter );
+        } );
+}
+
+//_________________________________
+bool Logbook::loadPreviousChild()
+{
+
+    Debug::Throw( QStringLiteral("Logbook::loadPreviousChild.\n") );
+
+    // find unloaded child with most recent entries
+    Logbook* previous( nullptr );
+    for( const auto& logbook:children() )
+    {
+        if( !logbook->loaded_ && ( !previous || previous->summary_.last < logbook->summary_.last ) )
+        { previous = logbook.get(); }
     }
 
-    // parse children
-    int entryCount( 0 );
-    for( auto&& node = docElement.firstChild(); !node.isNull(); node = node.nextSibling() )
+    return previous && previous->_readUnloaded();
+
+}
+
+//_________________________________
+bool Logbook::read()
+{
+
+    Debug::Throw( QStringLiteral("Logbook::read.\n") );
+
+    if( file_.isEmpty() )
     {
-        const auto element = node.toElement();
-        if( element.isNull() ) continue;
+        Debug::Throw( QStringLiteral("Logbook::read - file is empty.\n") );
+        return false;
+    }
 
-        const auto tagName( element.tagName() );
+    // read file
+    return _read( _readContent( file_, useSnapshot_ ) );
 
-        // children
-        if( tagName == Xml::Comments ) setComments( element.text() );
-        else if( tagName == Xml::Creation ) setCreation( XmlTimeStamp( element ) );
-        else if( tagName == Xml::Modification ) setModification( XmlTimeStamp( element ) );
-        else if( tagName == Xml::Backup ) setBackup( XmlTimeStamp( element ) );
-        else if( tagName == Xml::RecentEntries ) _readRecentEntries( element );
-        else if( tagName == Xml::BackupMask ) backupFiles_.append( Backup( element ) );
-        else if( tagName == Xml::Entry ) {
-
-            // create entry. Make sure it has a non zero keyword
-            LogEntry* entry = new LogEntry( element );
-
-            // make sure there is at least one valid keyword
-            auto keywords( entry->keywords() );
-            for( const auto& keyword:keywords )
-            { if( keyword.isRoot() ) entry->removeKeyword( keyword ); }
-            if( entry->keywords().empty() ) entry->addKeyword( Keyword::Default );
-
-            Base::Key::associate( this, entry );
-            entryCount++;
-            emit progressAvailable( 1 );
-
-        } else if( tagName == Xml::Child ) {
-
-            // try retrieve file from attributes
-            auto fileAttribute( element.attribute( Xml::File ) );
-            if( fileAttribute.isEmpty() )
-            {
-                Debug::Throw(0) << "Logbook::read - no file given for child" << Qt::endl;
-                continue;
-            }
+}
 
-            File file( fileAttribute );
-            if( !file.isAbsolute() ) file.addPath( Logbook::file_.path() );
-            LogbookPtr child( new Logbook );
-            child->setFile( file );
-            child->setUseCompression( useCompression_ );
+//_________________________________
+QList<Logbook*> Logbook::readAll( const QList<Logbook*>& logbooks )
+{
 
-            // propagate progressAvailable signal.
-            connect( child.get(), &Logbook::progressAvailable, this, &Logbook::progressAvailable );
-            connect( child.get(), &Logbook::messageAvailable, this, &Logbook::messageAvailable );
-            child->read();
-            children_.append( child );
+    Debug::Throw( QStringLiteral("Logbook::readAll.\n") );
 
-        } else Debug::Throw(0) << "Logbook::read - unrecognized tagName: " << tagName << Qt::endl;
+    /*
+    files are read and uncompressed on the global thread pool,
+    while entries are created and associated on this thread, in order.
+    Children are then read the same way as for a single logbook
+    */
+    QList<QFuture<Content>> futures;
+    for( const auto& logbook:logbooks )
+    {
+        if( logbook->file_.isEmpty() ) futures.append( QFuture<Content>() );
+        else futures.append( QtConcurrent::run( &Logbook::_readContent, logbook->file_, logbook->useSnapshot_ ) );
+    }
 
+    QList<Logbook*> out;
+    for( int index = 0; index < logbooks.size(); ++index )
+    {
+        const auto& logbook( logbooks[index] );
+        if( logbook->file_.isEmpty() || !logbook->_read( futures[index].result() ) ) out.append( logbook );
+        futures[index] = QFuture<Content>();
     }
 
-    // discard modifications
-    setModified( false );
-    saved_ = Logbook::file_.lastModified();
-    return true;
+    return out;
 
 }
 
@@ -273,142 +420,295 @@ bool Logbook::write( File file )
     if( file.isEmpty() ) file = Logbook::file_;
     if( file.isEmpty() ) return false;
 
-    bool completed = true;
-
-    // check number of entries and children to save in header
-    if( setXmlEntries( entries().size() ) || setXmlChildren( children().size() ) )
-    { setModified( true ); }
+    // collect this logbook and children, in order
+    /*
+    nothing is written if any child cannot be read.
+    This only happens when writing to a new file, and would otherwise leave the new logbook without it
+    */
+    WriteTask::List tasks;
+    if( !_prepareWrite( file, tasks ) ) return false;
+
+    /*
+    files are written to temporary files first, then all synced to disk at once, and finally moved in place,
+    so that a crash during the save never leaves a truncated file
+    */
+    writeStatistics_ = WriteStatistics();
+    QElapsedTimer timer;
+    timer.start();
+
+    // remove temporary file and skip, on failure
+    auto discard = []( WriteTask& task )
+    {
+        QFile::remove( task.temporary );
+        task.isNeeded = false;
+    };
 
-    emit maximumProgressAvailable( xmlEntries() );
+    // write this logbook
+    auto&& topTask( tasks.front() );
+    if( topTask.isNeeded && !_writeFile( topTask ) )
+    {
+        QFile::remove( topTask.temporary );
+        return false;
+    }
 
-    // write logbook if filename differs from origin or logbook is modified
-    if( file != file_ || modified_ )
+    bool completed( true );
+    if( parallelWrite_ && tasks.size() > 2 )
     {
 
-        // gets last saved timestamp
-        TimeStamp lastSaved( file.lastModified() );
+        /*
+        children are serialized in memory on this thread, then compressed and written on the global thread pool.
+        Both the number of pending files and the total size of their serialized content are bounded to limit memory usage.
+        The next file is always scheduled, whatever its size
+        */
+        const int maxPending( 2*std::max( 1, QThread::idealThreadCount() ) );
+        QList<QFuture<bool>> futures( { QFuture<bool>() } );
+        QList<qint64> sizes( { 0 } );
+        qint64 pendingSize( 0 );
+        for( int index = 1; index < tasks.size(); ++index )
+        {
 
-        // make a backup of the file, if necessary
-        if( XmlOptions::get().get<bool>( QStringLiteral("FILE_BACKUP") ) )
-        { file.backup(); }
+            // schedule next files
+            for( int next = futures.size(); next < tasks.size() && next <= index + maxPending && ( next == index || pendingSize < Local::maxPendingSize ); ++next )
+            {
+                auto&& nextTask( tasks[next] );
+                if( nextTask.isNeeded )
+                {
+                    const auto content( nextTask.logbook->_serialize( nextTask.file ) );
+                    pendingSize += content.size();
+                    sizes.append( content.size() );
+                    futures.append( QtConcurrent::run( Local::writeContent, nextTask.temporary, content, nextTask.logbook->_codec() ) );
+                } else {
+                    sizes.append( 0 );
+                    futures.append( QFuture<bool>() );
+                }
+            }
 
-        // update stateFrame
-        if( !QFile( file ).open( QIODevice::WriteOnly ) )
-        {
-            Debug::Throw(0) << "Logbook::write - unable to write to file " << file << Qt::endl;
-            return false;
-        }
+            // wait for result
+            auto&& task( tasks[index] );
+            pendingSize -= sizes[index];
+            if( task.isNeeded && !futures[index].result() )
+            {
+                Debug::Throw(0) << "Logbook::write - unable to write to file " << task.file << Qt::endl;
+                discard( task );
+                completed = false;
+            }
 
-        // create document
-        QDomDocument document;
+        }
 
-        // create main element
-        auto top = document.createElement( Xml::Logbook );
-        if( !title_.isEmpty() ) top.setAttribute( Xml::Title, title_ );
-        if( !directory_.isEmpty() ) top.setAttribute( Xml::Directory, directory_ );
-        if( !author_.isEmpty() ) top.setAttribute( Xml::Author, author_ ) ;
-        if( !parentFile_.isEmpty() ) top.setAttribute( Xml::ParentFile, parentFile_ );
+    } else {
 
-        top.setAttribute( Xml::SortMethod, QString::number( Base::toIntegralType( sortMethod_ ) ) );
-        top.setAttribute( Xml::SortOrder, QString::number( sortOrder_ ) );
-        top.setAttribute( Xml::ReadOnly, QString::number( readOnly_ ) );
-        top.setAttribute( Xml::BackupMask, QString::number( isBackup_ ) );
+        for( int index = 1; index < tasks.size(); ++index )
+        {
+            auto&& task( tasks[index] );
+            if( task.isNeeded && !task.logbook->_writeFile( task ) )
+            {
+                discard( task );
+                completed = false;
+            }
+        }
 
-        // update number of entries and children
-        top.setAttribute( Xml::Entries, QString::number(xmlEntries()) );
-        top.setAttribute( Xml::Children, QString::number(xmlChildren()) );
+    }
 
-        // append node
-        document.appendChild( top );
+    writeStatistics_.writeTime = timer.restart();
 
-        // comments
-        if( comments().size() )
+    // sync all written files
+    for( auto&& task:tasks )
+    {
+        if( task.isNeeded && !FileSync::sync( task.temporary ) )
         {
-            auto commentsElement = document.createElement( Xml::Comments );
-            auto commentsText = document.createTextNode( comments() );
-            commentsElement.appendChild( commentsText );
-            top.appendChild( commentsElement );
+            Debug::Throw(0) << "Logbook::write - unable to sync file " << task.temporary << Qt::endl;
+            discard( task );
+            completed = false;
         }
+    }
 
-        // write time stamps
-        if( creation().isValid() ) top.appendChild( XmlTimeStamp( creation() ).domElement( Xml::Creation, document ) );
-        if( modification().isValid() ) top.appendChild( XmlTimeStamp( modification() ).domElement( Xml::Modification, document ) );
-        if( backup().isValid() ) top.appendChild( XmlTimeStamp( backup() ).domElement( Xml::Backup, document ) );
+    writeStatistics_.syncTime = timer.restart();
 
-        // write recent entries
-        if( !recentEntries_.empty() ) top.appendChild( _recentEntriesElement( document ) );
+    /*
+    move files in place, then sync their directories.
+    Children are moved first and the top-level file last, so that a crash in between never leaves
+    a top-level file referring to children that are not written yet.
+    Permissions of replaced files are preserved
+    */
+    QSet<QString> directories;
+    for( auto iter = tasks.rbegin(); iter != tasks.rend(); ++iter )
+    {
+        auto&& task( *iter );
+        if( !task.isNeeded ) continue;
+        if( task.target.exists() ) QFile::setPermissions( task.temporary, QFile::permissions( task.target ) );
+        if( FileSync::replace( task.temporary, task.target ) ) directories.insert( task.target.path() );
+        else {
+            discard( task );
+            completed = false;
+        }
+    }
 
-        // write backup files
-        for( const auto& backup:backupFiles_ )
-        { top.appendChild( backup.domElement( document ) ); }
+    for( const auto& directory:directories )
+    {
+        if( !FileSync::syncDirectory( File( directory ) ) )
+        { Debug::Throw(0) << "Logbook::write - unable to sync directory " << directory << Qt::endl; }
+    }
 
-        // write all entries
-        int entryCount( 0 );
-        Base::KeySet<LogEntry> entries( this );
-        for( const auto& entry:entries )
-        {
+    writeStatistics_.renameTime = timer.elapsed();
 
-            top.appendChild( entry->domElement( document ) );
-            entryCount++;
-            emit progressAvailable( 1 );
+    // commit
+    for( const auto& task:tasks )
+    { if( !task.logbook->_commitWrite( task, writeStatistics_ ) ) completed = false; }
 
-        }
+    Debug::Throw()
+        << "Logbook::write - " << writeStatistics_.files << " files, " << writeStatistics_.bytes << " bytes written."
+        << " write: " << writeStatistics_.writeTime << "ms"
+        << " sync: " << writeStatistics_.syncTime << "ms"
+        << " rename: " << writeStatistics_.renameTime << "ms"
+        << Qt::endl;
 
-        // dump all logbook childrens
-        for( int childCount = 0; childCount < children_.size(); ++childCount )
-        {
-            auto childFileName = Local::childFileName( file, childCount );
-            auto childElement = document.createElement( Xml::Child );
-            childElement.setAttribute( Xml::File, childFileName );
-            top.appendChild( childElement );
-        }
+    // journaled changes are now in the logbook files
+    if( completed ) Journal::remove( file_ );
+    return completed;
 
-        // finish
-        QFile out( file );
-        out.open( QIODevice::WriteOnly );
-        if( useCompression_ ) out.write( qCompress( document.toByteArray() ) );
-        else out.write( document.toByteArray() );
-        out.close();
+}
 
-        // gets/check new saved timestamp
-        TimeStamp savedNew( file.lastModified() );
-        if( !( lastSaved < savedNew ) ) completed = false;
-        else if( file == file_ )  modified_ = false;
+//_________________________________
+bool Logbook::writeJournal()
+{
 
-        // assign new filename
-        if( file != file_ ) setFile( file );
+    Debug::Throw( QStringLiteral("Logbook::writeJournal.\n") );
 
-    } else { emit progressAvailable( Base::KeySet<LogEntry>( this ).size() ); }
+    if( !useJournal_ || file_.isEmpty() || !file_.exists() ) return false;
 
-    // update saved timeStamp
-    saved_ = file_.lastModified();
+    // too large journals are compacted by writing the logbook files
+    const File journal( Journal::file( file_ ) );
+    if( journal.exists() && journal.fileSize() > Journal::MaxSize ) return false;
 
-    // write children
-    int childCount=0;
-    for( const auto& logbook:children_ )
-    {
+    // removals come first, for entries moved from one child to another to be replayed properly
+    Journal::Record::List removed;
+    Journal::Record::List written;
+    _collectJournal( removed, written );
+    if( removed.empty() && written.empty() ) return true;
 
-        File childFileName( Local::childFileName( file, childCount ).addPath( file.path() ) );
+    if( !Journal::append( file_, removed + written ) ) return false;
+    _commitJournal();
 
-        logbook->setParentFile( file );
-        if( !logbook->write( childFileName ) ) completed = false;
+    Debug::Throw() << "Logbook::writeJournal - " << removed.size() + written.size() << " records" << Qt::endl;
+    return true;
 
-        ++childCount;
+}
+
+//_________________________________
+void Logbook::addEntry( LogEntry* entry )
+{
+    if( entry->isAssociated( this ) ) return;
+    Base::Key::associate( this, entry );
+    for( auto logbook = this; logbook; logbook = logbook->parent_ )
+    { logbook->entries_.insert( entry ); }
+
+    auto& root( _root() );
+    root.entryIndex_.insert( entry );
+    root.keywordIndex_.insert( entry );
+    ++entryCount_;
+    entrySize_ += entry->approximateSize();
+}
+
+//_________________________________
+void Logbook::removeEntry( LogEntry* entry )
+{
+    if( !entry->isAssociated( this ) ) return;
+    Base::Key::disassociate( this, entry );
+    for( auto logbook = this; logbook; logbook = logbook->parent_ )
+    { logbook->entries_.remove( entry ); }
+
+    auto& root( _root() );
+    root.entryIndex_.remove( entry );
+    root.keywordIndex_.remove( entry );
+    --entryCount_;
+    entrySize_ -= entry->approximateSize();
+
+    // this child is not full anymore
+    if( parent_ ) parent_->firstNonFull_ = std::min( parent_->firstNonFull_, childIndex_ );
+}
+
+//_________________________________
+void Logbook::clearEntries()
+{
+    auto& root( _root() );
+    for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+    {
+        for( auto logbook = this; logbook; logbook = logbook->parent_ )
+        { logbook->entries_.remove( entry ); }
 
+        root.entryIndex_.remove( entry );
+        root.keywordIndex_.remove( entry );
     }
 
-    return completed;
+    removeAssociatedKeys<LogEntry>();
+    entryCount_ = 0;
+    entrySize_ = 0;
+    if( parent_ )
+    {
+        parent_->firstNonFull_ = std::min( parent_->firstNonFull_, childIndex_ );
+        parent_->monthChildren_.clear();
+    }
+}
+
+//_________________________________
+void Logbook::addEntryKeyword( LogEntry* entry, const Keyword& keyword )
+{ if( entry->isAssociated( this ) ) _root().keywordIndex_.insert( entry, keyword ); }
 
+//_________________________________
+void Logbook::removeEntryKeyword( LogEntry* entry, const Keyword& keyword )
+{ if( entry->isAssociated( this ) ) _root().keywordIndex_.remove( entry, keyword ); }
+
+//_________________________________
+void Logbook::updateEntrySize( LogEntry* entry, qint64 delta )
+{
+    if( !entry->isAssociated( this ) ) return;
+    entrySize_ += delta;
+
+    // this child may not be full anymore
+    if( delta < 0 && parent_ ) parent_->firstNonFull_ = std::min( parent_->firstNonFull_, childIndex_ );
 }
 
 //_________________________________
-QHash<LogEntry*,LogEntry*> Logbook::synchronize( const Logbook& logbook )
+QHash<LogEntry*,LogEntry*> Logbook::synchronize( Logbook& logbook )
 {
     Debug::Throw( QStringLiteral("Logbook::synchronize.\n") );
 
-    // retrieve logbook entries
-    auto newEntries( logbook.entries() );
-    auto currentEntries( entries() );
+    /*
+    children with the same summary hash on both sides hold the same entries, which would all be skipped.
+    Other children are loaded on both sides, to find duplicates
+    */
+    const auto hashes( _childrenHashes() );
+    if( logbook.children_.empty() )
+    {
+
+        // entries held directly by the remote logbook can only match children covering their creation time
+        QList<TimeStamp> timeStamps;
+        for( const auto& entry:logbook.entries() )
+        { timeStamps.append( entry->creation() ); }
+        loadChildren( timeStamps );
+
+    } else {
+
+        const auto remoteHashes( logbook._childrenHashes() );
+        _loadChildren( [&remoteHashes]( const Logbook& child ) { return !remoteHashes.contains( child.summary_.hash ); } );
+        logbook._loadChildren( [&hashes]( const Logbook& child ) { return !hashes.contains( child.summary_.hash ); } );
+
+    }
+
+    synchronizeStatistics_ = SynchronizeStatistics();
+
+    // retrieve logbook entries from children that differ
+    Base::KeySet<LogEntry> newEntries( &logbook );
+    for( const auto& child:logbook.children_ )
+    {
+        const auto summary( child->loaded_ ? child->_summary():child->summary_ );
+        if( hashes.contains( summary.hash ) ) synchronizeStatistics_.skipped += summary.entries;
+        else newEntries.unite( child->entries() );
+    }
+
+    // current entries by identifier. The index is updated as entries are added and removed
+    const auto& currentEntries( entryIndex() );
+    const auto& remoteEntries( logbook.entryIndex() );
 
     // map of duplicated entries
     QHash< LogEntry*, LogEntry* > duplicates;
@@ -417,45 +717,147 @@ QHash<LogEntry*,LogEntry*> Logbook::synchronize( const Logbook& logbook )
     for( const auto& entry:newEntries )
     {
 
-        // check if there is an entry with matching creation and modification time
-        auto duplicate( std::find_if( currentEntries.begin(), currentEntries.end(), LogEntry::DuplicateFTor( entry ) ) );
+        const auto hash( entry->contentHash() );
 
-        // if duplicate entry found and modified more recently, skip the new entry
-        if( duplicate != currentEntries.end() && (*duplicate)->modification() >= entry->modification() ) continue;
+        // check if there is an entry with matching identifier
+        auto duplicate( currentEntries.find( entry->id() ) );
 
-        // retrieve logbook where entry is to be added
-        auto child( latestChild() );
+        // entries saved before identifiers were introduced are also matched on creation time
+        bool legacyMatch( false );
+        if( !duplicate && LogEntry::isLegacyId( entry->id() ) )
+        {
+            duplicate = Local::legacyDuplicate( currentEntries, remoteEntries, entry );
+            legacyMatch = ( duplicate != nullptr );
+        }
 
-        // create a new entry
-        auto copy( entry->copy() );
+        // field groups to be taken from the new entry
+        LogEntry::Groups groups( 0 );
+        LogEntry::ContentHash base( hash );
+        if( !duplicate ) groups = LogEntry::AllGroups;
+        else {
 
-        // associate entry with logbook
-        Base::Key::associate( copy, child.get() );
+            const auto localHash( duplicate->contentHash() );
+            const auto differences( localHash.differences( hash ) );
+            const auto& localBase( duplicate->baseHash() );
+            const auto& remoteBase( entry->baseHash() );
 
-        // set child as modified
-        child->setModified( true );
+            Conflict conflict;
+            if( !differences ) {
 
-        // safe remove the duplicated entry
-        if( duplicate != currentEntries.end() )
-        {
-            // set logbooks as modified
-            // and disassociate with entry
-            for( const auto& logbook:Base::KeySet<Logbook>( *duplicate ) )
-            {
-                logbook->setModified( true );
-                Base::Key::disassociate( logbook, *duplicate );
-            }
+                // identical entries
+                Local::setBaseHash( duplicate, hash );
+                ++synchronizeStatistics_.skipped;
+                continue;
 
-            // insert duplicate pairs in map
-            duplicates.insert( *duplicate, entry );
+            } else if( localBase == hash ) {
 
-            // reset current entries
-            currentEntries = entries();
+                // new entry is unchanged since it was last merged locally
+                ++synchronizeStatistics_.skipped;
+                continue;
+
+            } else if( remoteBase == localHash ) {
+
+                // local entry is unchanged since it was last merged remotely
+                groups = differences;
+
+            } else if( localBase.valid && localBase == remoteBase ) {
+
+                // three-way merge, using the common base
+                const auto localChanges( localHash.differences( localBase ) );
+                const auto remoteChanges( hash.differences( remoteBase ) );
+                groups = remoteChanges & ~localChanges;
+                conflict.groups = differences & localChanges & remoteChanges;
+                conflict.hasBase = true;
+
+            } else conflict.groups = differences;
+
+            // conflicting groups are taken from the most recently modified entry
+            if( conflict.groups )
+            {
+                conflict.creation = entry->creation();
+                conflict.title = entry->title();
+                conflict.remoteKept = duplicate->modification() < entry->modification();
+                if( conflict.remoteKept ) groups |= conflict.groups;
+                synchronizeStatistics_.conflicts.append( conflict );
+            }
+
+            /*
+            when local entry is kept over conflicting groups, its base is set to the new entry hash,
+            so that the new entry gets replaced when synchronizing the other way
+            */
+            if( !groups )
+            {
+                if( conflict.groups ) Local::setBaseHash( duplicate, hash );
+                ++synchronizeStatistics_.skipped;
+                continue;
+            }
+
+            // base of merged entry
+            if( !conflict.groups ) base = localBase;
+
+        }
+
+        /*
+        create a new entry, either as a copy of the new entry or merged with the local one.
+        Merged entries keep their common base, unless conflicting
+        */
+        LogEntry* copy( nullptr );
+        if( groups == LogEntry::AllGroups || !( duplicate->contentHash().differences( hash ) & ~groups ) )
+        {
+
+            copy = entry->copy();
+            copy->setBaseHash( hash );
+
+        } else {
+
+            copy = duplicate->copy();
+            copy->merge( *entry, groups );
+            copy->setBaseHash( base );
 
         }
 
+        // entries matched on creation time keep the lowest identifier, for all copies of the logbook to converge
+        if( legacyMatch ) copy->setId( std::min( duplicate->id(), entry->id() ) );
+
+        // retrieve logbook where entry is to be added
+        auto child( childFor( copy ) );
+
+        // associate entry with logbook
+        child->addEntry( copy );
+
+        // set child as modified
+        child->setModified( true );
+
+        // safe remove the duplicated entry
+        if( duplicate )
+        {
+            // count merged entries
+            if( duplicate->contentHash() != copy->contentHash() && hash != copy->contentHash() ) ++synchronizeStatistics_.merged;
+            else ++synchronizeStatistics_.replaced;
+
+            // set logbooks as modified
+            // and disassociate with entry
+            for( const auto& logbook:Base::KeySet<Logbook>( duplicate ) )
+            {
+                logbook->setModified( true );
+                logbook->removeEntry( duplicate );
+            }
+
+            // insert duplicate pairs in map
+            duplicates.insert( duplicate, copy );
+
+        } else ++synchronizeStatistics_.added;
+
     }
 
+    Debug::Throw()
+        << "Logbook::synchronize - added: " << synchronizeStatistics_.added
+        << " replaced: " << synchronizeStatistics_.replaced
+        << " merged: " << synchronizeStatistics_.merged
+        << " skipped: " << synchronizeStatistics_.skipped
+        << " conflicts: " << synchronizeStatistics_.conflicts.size()
+        << Qt::endl;
+
     return duplicates;
 
 }
@@ -492,48 +894,32 @@ Logbook::LogbookPtr Logbook::latestChild()
 
     Debug::Throw( QStringLiteral("Logbook::latestChild.\n") );
 
-    // check if one existsing child is not complete
-    for( const auto& logbook:children_ )
+    if( sharding_.byMonth ) return _monthChild( Local::month( TimeStamp::now() ) );
+
+    // check if one existsing child is not complete, starting from the first one that might not be
+    for( firstNonFull_ = std::min<int>( firstNonFull_, children_.size() ); firstNonFull_ < children_.size(); ++firstNonFull_ )
     {
-        if( logbook && Base::KeySet<LogEntry>(logbook.get()).size() < MaxEntries )
+        const auto& logbook( children_[firstNonFull_] );
+        if( logbook && !_isFull( *logbook ) )
         { return logbook; }
     }
 
     // add a new child if nothing found
-    LogbookPtr logbook( new Logbook );
-    logbook->setTitle( title() );
-    logbook->setDirectory( directory() );
-    logbook->setAuthor( author() );
-    logbook->setFile( Local::childFileName( file_, children_.size() ).addPath( file_.path() ) );
-    logbook->setUseCompression( useCompression_ );
-    logbook->setModified( true );
-    connect( logbook.get(), &Logbook::messageAvailable, this, &Logbook::messageAvailable );
-
-    children_.append( logbook );
-    setModified( true );
-
-    // associate to existing FileCheck if any
-    Base::KeySet<FileCheck> fileChecks( this );
-    if( !fileChecks.empty() )
-    { (*fileChecks.begin())->registerLogbook( logbook.get() ); }
-
-    return logbook;
+    return _newChild();
 
 }
 
 //_________________________________
-Base::KeySet<LogEntry> Logbook::entries() const
+Logbook::LogbookPtr Logbook::childFor( const LogEntry* entry )
 {
-
-    Base::KeySet<LogEntry> out( this );
-
-    for( const auto& logbook:children_ )
-    { out.unite( logbook->entries() ); }
-
-    return out;
-
+    if( sharding_.byMonth ) return _monthChild( Local::month( entry->creation() ) );
+    else return latestChild();
 }
 
+//_________________________________
+Base::KeySet<LogEntry> Logbook::entries() const
+{ return entries_; }
+
 //_________________________________
 Base::KeySet<Attachment> Logbook::attachments() const
 {
@@ -576,13 +962,26 @@ void Logbook::removeEmptyChildren()
         if( logbook->empty() )
         {
 
-            // remove file
-            if( !logbook->file_.isEmpty() ) logbook->file_.remove();
+            // remove file and snapshot
+            if( !logbook->file_.isEmpty() )
+            {
+                logbook->file_.remove();
+                Snapshot::file( logbook->file_ ).remove();
+            }
+
+            logbook->parent_ = nullptr;
+
+        } else {
 
-        } else tmp.append( logbook );
+            logbook->childIndex_ = tmp.size();
+            tmp.append( logbook );
+
+        }
     }
 
     children_.swap( tmp );
+    firstNonFull_ = 0;
+    monthChildren_.clear();
 
     return;
 }
@@ -594,11 +993,20 @@ QList<LogEntry*> Logbook::recentEntries() const
     QList<LogEntry*> out;
     if( recentEntries_.empty() ) return out;
 
-    Base::KeySet<LogEntry> entries( this->entries() );
-    for( const auto& timeStamp:recentEntries_ )
+    const auto& entries( entryIndex() );
+
+    // recent entries saved before identifiers were introduced refer to entries by creation time stamp
+    QHash<quint64, LogEntry*> legacyEntries;
+    if( std::any_of( recentEntries_.begin(), recentEntries_.end(), []( quint64 id ) { return !LogEntry::isGeneratedId( id ); } ) )
+    {
+        for( const auto& entry:this->entries() )
+        { legacyEntries.insert( LogEntry::derivedId( entry->creation() ), entry ); }
+    }
+
+    for( const auto& id:recentEntries_ )
     {
-        auto entryIter( std::find_if( entries.begin(), entries.end(), LogEntry::SameCreationFTor( timeStamp ) ) );
-        if( entryIter != entries.end() ) out.append( *entryIter );
+        auto entry( LogEntry::isGeneratedId( id ) ? entries.find( id ):legacyEntries.value( id, nullptr ) );
+        if( entry && !out.contains( entry ) ) out.append( entry );
     }
 
     return out;
@@ -610,13 +1018,15 @@ void Logbook::addRecentEntry( const LogEntry* entry )
 {
 
     Debug::Throw( QStringLiteral("Logbook::addRecentEntry.\n") );
-    auto timeStamp( entry->creation() );
+    const auto id( entry->id() );
 
-    // first remove time stamp from list if it exists
-    recentEntries_.erase( std::remove( recentEntries_.begin(), recentEntries_.end(), timeStamp ), recentEntries_.end() );
+    // first remove identifier from list if it exists, including legacy identifier derived from creation time stamp
+    const auto legacyId( LogEntry::derivedId( entry->creation() ) );
+    recentEntries_.erase( std::remove_if( recentEntries_.begin(), recentEntries_.end(),
+        [id, legacyId]( quint64 current ) { return current == id || current == legacyId; } ), recentEntries_.end() );
 
     // add again at the end of the list
-    recentEntries_.append( timeStamp );
+    recentEntries_.append( id );
 
     // mark logbook as modified
     setModified( true );
@@ -641,6 +1051,7 @@ void Logbook::setFile( const File &file, bool recursive )
         for( const auto& logbook:children_ )
         {
             File childFileName( Local::childFileName( file, childCount ).addPath( file.path() ) );
+            logbook->_readUnloaded();
             logbook->setParentFile( file );
             logbook->setFile( childFileName, true );
             ++childCount;
@@ -848,35 +1259,1233 @@ void Logbook::setBackupFiles( const Backup::List& backups )
 }
 
 //______________________________________________________________________
-void Logbook::_readRecentEntries( const QDomElement& element )
+Logbook::Content Logbook::_readContent( const File& file, bool useSnapshot )
 {
 
-    Debug::Throw( QStringLiteral("Logbook::_readRecentEntries.\n") );
-    recentEntries_.clear();
+    Content out;
 
-    // loop over children
-    for( auto&& node = element.firstChild(); !node.isNull(); node = node.nextSibling() )
+    // check input file
+    if( !file.exists() )
     {
-        const auto childElement = node.toElement();
-        if( childElement.isNull() ) continue;
+        out.error = QStringLiteral( "cannot access file \"%1\"" ).arg( file );
+        return out;
+    }
 
-        // children
-        const auto tagName( childElement.tagName() );
-        if( tagName == Xml::Creation ) recentEntries_.append( XmlTimeStamp( childElement ) );
+    QFile in( file );
+    if( !in.open( QIODevice::ReadOnly ) )
+    {
+        out.error = QStringLiteral( "cannot open file \"%1\"" ).arg( file );
+        return out;
+    }
+
+    // read everything from file
+    const auto raw( in.readAll() );
+
+    // use snapshot if it matches
+    if( useSnapshot )
+    {
+        out.signature = Snapshot::signature( file, raw );
+        out.snapshot = Snapshot::read( file, out.signature );
+        if( !out.snapshot.isEmpty() )
+        {
+            out.isValid = true;
+            return out;
+        }
+    }
+
+    // decode
+    out.isValid = FileFormat::decode( raw, out.data, out.error );
+    if( !out.isValid ) out.error = QStringLiteral( "cannot decode file \"%1\": %2" ).arg( file.get(), out.error );
+    return out;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_load( const Content& content )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_load.\n") );
+
+    if( !content.snapshot.isEmpty() )
+    {
+
+        if( _parseSnapshot( content.snapshot ) ) return true;
+
+        // fallback to xml. The snapshot gets overwritten once parsed
+        Debug::Throw(0) << "Logbook::read - invalid snapshot for " << file_ << Qt::endl;
+        auto xmlContent( _readContent( file_, false ) );
+        if( !xmlContent.isValid )
+        {
+            Debug::Throw(0) << "Logbook::read - ERROR: " << xmlContent.error << Qt::endl;
+            return false;
+        }
+
+        xmlContent.signature = content.signature;
+        return _load( xmlContent );
+
+    }
+
+    if( !_parse( content.data ) ) return false;
+
+    // regenerate snapshot, for next time
+    if( useSnapshot_ ) _updateSnapshot( content.signature );
+    return true;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_parse( const QByteArray& content )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_parse.\n") );
+
+    // parse
+    /* entries are created directly from the xml stream, without building the full document */
+    const int childCount( children_.size() );
+    QXmlStreamReader reader( content );
+    if( !reader.readNextStartElement() || !_read( reader ) || reader.hasError() )
+    {
+
+        // delete entries and children read so far
+        for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+        { delete entry; }
+        assignedIdEntries_.clear();
+
+        while( children_.size() > childCount )
+        { children_.removeLast(); }
+
+        // parse again as DOM to retrieve detailed error, consistently with previous versions
+        if( reader.hasError() )
+        {
+            QDomDocument document;
+            document.setContent( content, error_ );
+        }
+
+        return false;
+
+    }
+
+    // read children
+    _readChildren( children_.mid( childCount ) );
+
+    // discard modifications
+    setModified( false );
+    _clearChanges();
+    saved_ = Logbook::file_.lastModified();
+    _keepAssignedIds();
+    return true;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_parseSnapshot( const QByteArray& payload )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_parseSnapshot.\n") );
+
+    const int childCount( children_.size() );
+    const int backupCount( backupFiles_.size() );
+    QDataStream stream( payload );
+    Snapshot::setup( stream );
+    if( !_readSnapshot( stream ) )
+    {
+
+        // delete entries, children and backups read so far
+        for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+        { delete entry; }
+        assignedIdEntries_.clear();
+
+        while( children_.size() > childCount )
+        { children_.removeLast(); }
+
+        backupFiles_.resize( backupCount );
+        return false;
+
+    }
+
+    // read children
+    _readChildren( children_.mid( childCount ) );
+
+    // discard modifications
+    setModified( false );
+    _clearChanges();
+    saved_ = Logbook::file_.lastModified();
+    _keepAssignedIds();
+    return true;
+
+}
+
+//______________________________________________________________________
+void Logbook::_readChildren( const List& all )
+{
+
+    // skip children out of loaded range
+    List children;
+    for( const auto& child:all )
+    {
+        if( child->summary_.isValid() && ( manifestOnly_ || ( loadedSince_.isValid() && child->summary_.last < loadedSince_ ) ) ) child->loaded_ = false;
+        else children.append( child );
+    }
+
+    if( children.empty() ) return;
+    Debug::Throw( QStringLiteral("Logbook::_readChildren.\n") );
+
+    /*
+    files are read and uncompressed on the global thread pool, while
+    entries are created and associated on this thread, in the children order.
+    The number of pending files is bounded to limit memory usage.
+    */
+    const int maxPending( 2*std::max( 1, QThread::idealThreadCount() ) );
+    QList<QFuture<Content>> futures;
+    for( int index = 0; index < children.size(); ++index )
+    {
+
+        // schedule next files
+        for( int next = futures.size(); next < children.size() && next <= index + maxPending; ++next )
+        {
+            const auto& child( children[next] );
+            futures.append( QtConcurrent::run( &Logbook::_readContent, child->file_, child->useSnapshot_ ) );
+        }
+
+        // wait for content and release future
+        const auto content( futures[index].result() );
+        futures[index] = QFuture<Content>();
+
+        // parse
+        const auto& child( children[index] );
+        if( !content.isValid ) Debug::Throw(0) << "Logbook::read - ERROR: " << content.error << Qt::endl;
+        else child->_load( content );
+
+    }
+
+}
+
+//______________________________________________________________________
+bool Logbook::_read( const Content& content )
+{
+
+    if( !content.isValid )
+    {
+        Debug::Throw(0) << "Logbook::read - ERROR: " << content.error << Qt::endl;
+        return false;
+    }
+
+    // delete associated entries
+    for( const auto& entry:this->entries() )
+    { delete entry; }
+
+    // parse
+    if( !_load( content ) ) return false;
+
+    // apply changes journaled since files were last written
+    _replayJournal();
+    return true;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_readUnloaded()
+{
+
+    if( loaded_ ) return false;
+    Debug::Throw() << "Logbook::_readUnloaded - " << file_ << Qt::endl;
+
+    const auto content( _readContent( file_, useSnapshot_ ) );
+    if( !content.isValid )
+    {
+        Debug::Throw(0) << "Logbook::read - ERROR: " << content.error << Qt::endl;
+        return false;
+    }
+
+    if( !_load( content ) ) return false;
+    loaded_ = true;
+
+    // this child can now receive entries
+    if( parent_ )
+    {
+        parent_->firstNonFull_ = std::min( parent_->firstNonFull_, childIndex_ );
+        parent_->monthChildren_.clear();
+    }
+
+    return true;
+
+}
+
+//______________________________________________________________________
+Logbook::Summary Logbook::_summary() const
+{
+
+    Summary out;
+    for( const auto& entry:entries() )
+    {
+        const auto& creation( entry->creation() );
+        if( !out.first.isValid() || creation < out.first ) out.first = creation;
+        if( !out.last.isValid() || out.last < creation ) out.last = creation;
+        if( !out.modification.isValid() || out.modification < entry->modification() ) out.modification = entry->modification();
+        out.hash += Local::entryHash( entry );
+        for( const auto& keyword:entry->keywords() )
+        { out.keywords.insert( keyword ); }
+    }
+
+    out.entries = entries().size();
+
+    // unloaded children
+    for( const auto& logbook:children() )
+    { if( !logbook->loaded_ ) out.merge( logbook->summary_ ); }
+
+    return out;
+
+}
 
+//______________________________________________________________________
+bool Logbook::_updateSummaries()
+{
+    bool changed( false );
+    for( const auto& logbook:children_ )
+    {
+        if( !logbook->loaded_ ) continue;
+        const auto summary( logbook->_summary() );
+        if( summary == logbook->summary_ ) continue;
+        logbook->summary_ = summary;
+        changed = true;
     }
 
+    return changed;
 }
 
 //______________________________________________________________________
-QDomElement Logbook::_recentEntriesElement( QDomDocument& document ) const
+int Logbook::_unloadedEntryCount() const
 {
-    Debug::Throw( QStringLiteral("Logbook::_recentEntriesElement.\n") );
+    int out( 0 );
+    for( const auto& logbook:children() )
+    { if( !logbook->loaded_ ) out += logbook->summary_.entries; }
+
+    return out;
+}
 
-    auto out( document.createElement( Xml::RecentEntries ) );
-    for( const auto& timeStamp:recentEntries_ )
-    { out.appendChild( XmlTimeStamp( timeStamp ).domElement( Xml::Creation, document ) ); }
+//______________________________________________________________________
+QSet<quint64> Logbook::_childrenHashes() const
+{
+    QSet<quint64> out;
+    for( const auto& logbook:children_ )
+    { out.insert( logbook->loaded_ ? logbook->_summary().hash:logbook->summary_.hash ); }
 
     return out;
+}
+
+//______________________________________________________________________
+bool Logbook::Summary::operator == ( const Summary& other ) const
+{
+    return
+        entries == other.entries &&
+        hash == other.hash &&
+        first.unixTime() == other.first.unixTime() &&
+        last.unixTime() == other.last.unixTime() &&
+        modification.unixTime() == other.modification.unixTime() &&
+        keywords == other.keywords;
+}
+
+//______________________________________________________________________
+void Logbook::Summary::merge( const Summary& other )
+{
+    if( !other.isValid() ) return;
+    if( !first.isValid() || other.first < first ) first = other.first;
+    if( !last.isValid() || last < other.last ) last = other.last;
+    if( !modification.isValid() || modification < other.modification ) modification = other.modification;
+    entries += other.entries;
+    hash += other.hash;
+    keywords.unite( other.keywords );
+}
+
+//______________________________________________________________________
+bool Logbook::_read( QXmlStreamReader& reader )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_read.\n") );
+
+    // check top-level tag
+    if( reader.name() != Xml::Logbook )
+    {
+        Debug::Throw(0) << "Logbook::read - invalid tag name: " << reader.name().toString() << Qt::endl;
+        return false;
+    }
+
+    // read attributes
+    for( const auto& attribute:reader.attributes() )
+    {
+
+        const auto name( attribute.name().toString() );
+        const auto value( attribute.value().toString() );
+
+        if( name == Xml::Title ) setTitle( value );
+        else if( name == Xml::File ) setFile( File( value ) );
+        else if( name == Xml::ParentFile ) setParentFile( File( value ) );
+        else if( name == Xml::Directory ) setDirectory( File( value ) );
+        else if( name == Xml::Author ) setAuthor( value );
+        else if( name == Xml::SortMethod ) setSortMethod( (SortMethod) value.toInt() );
+        else if( name == Xml::SortOrder ) setSortOrder( value.toInt() );
+        else if( name == Xml::ReadOnly ) setReadOnly( value.toInt() );
+        else if( name == Xml::BackupMask ) setIsBackup( value.toInt() );
+        else if( name == Xml::Entries ) {
+
+            setXmlEntries( value.toInt() );
+            emit maximumProgressAvailable( value.toInt() );
+
+        } else if( name == Xml::Children ) setXmlChildren( value.toInt() );
+        else Debug::Throw(0) << "Logbook::read - unrecognized logbook attribute: \"" << name << "\"\n";
+
+    }
+
+    // parse children
+    QDomDocument document;
+    while( reader.readNextStartElement() )
+    {
+
+        const auto tagName( reader.name().toString() );
+
+        // children
+        if( tagName == Xml::Comments ) setComments( reader.readElementText( QXmlStreamReader::IncludeChildElements ) );
+        else if( tagName == Xml::Creation ) setCreation( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == Xml::Modification ) setModification( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == Xml::Backup ) setBackup( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) );
+        else if( tagName == Xml::RecentEntries ) _readRecentEntries( reader );
+        else if( tagName == Xml::BackupMask ) backupFiles_.append( Backup( reader ) );
+        else if( tagName == Xml::Entry ) _addEntry( new LogEntry( reader ) );
+        else if( tagName == Xml::Child ) {
+
+            // try retrieve file and summary from attributes
+            QString fileAttribute;
+            Summary summary;
+            for( const auto& attribute:reader.attributes() )
+            {
+                const auto name( attribute.name().toString() );
+                const auto value( attribute.value().toString() );
+                if( name == Xml::File ) fileAttribute = value;
+                else if( name == Xml::Entries ) summary.entries = value.toInt();
+                else if( name == Xml::FirstCreation ) summary.first = TimeStamp( static_cast<time_t>( value.toLongLong() ) );
+                else if( name == Xml::LastCreation ) summary.last = TimeStamp( static_cast<time_t>( value.toLongLong() ) );
+                else if( name == Xml::LastModification ) summary.modification = TimeStamp( static_cast<time_t>( value.toLongLong() ) );
+                else if( name == Xml::Hash ) summary.hash = value.toULongLong( nullptr, 16 );
+            }
+
+            // keywords
+            while( reader.readNextStartElement() )
+            {
+                if( reader.name() == Xml::Keyword ) summary.keywords.insert( Keyword( reader ) );
+                else reader.skipCurrentElement();
+            }
+
+            if( fileAttribute.isEmpty() )
+            {
+                Debug::Throw(0) << "Logbook::read - no file given for child" << Qt::endl;
+                continue;
+            }
+
+            _addChild( File( fileAttribute ), summary );
+
+        } else {
+
+            Debug::Throw(0) << "Logbook::read - unrecognized tagName: " << tagName << Qt::endl;
+            reader.skipCurrentElement();
+
+        }
+
+    }
+
+    return !reader.hasError();
+
+}
+
+//______________________________________________________________________
+void Logbook::_readRecentEntries( QXmlStreamReader& reader )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_readRecentEntries.\n") );
+    recentEntries_.clear();
+
+    // loop over children
+    /* recent entries stored by creation time stamp refer to entries with derived identifiers */
+    QDomDocument document;
+    while( reader.readNextStartElement() )
+    {
+        if( reader.name() == Xml::Entry )
+        {
+
+            const auto id( reader.attributes().value( Xml::Id ).toString().toULongLong( nullptr, 16 ) );
+            if( id ) recentEntries_.append( id );
+            reader.skipCurrentElement();
+
+        } else if( reader.name() == Xml::Creation ) recentEntries_.append( LogEntry::derivedId( XmlTimeStamp( XmlStreamUtil::readElement( reader, document ) ) ) );
+        else reader.skipCurrentElement();
+    }
+
+}
+
+//______________________________________________________________________
+void Logbook::_addEntry( LogEntry* entry )
+{
+
+    // make sure there is at least one valid keyword
+    auto keywords( entry->keywords() );
+    for( const auto& keyword:keywords )
+    { if( keyword.isRoot() ) entry->removeKeyword( keyword ); }
+    if( entry->keywords().empty() ) entry->addKeyword( Keyword::Default );
+
+    /*
+    assign identifier to entries saved before identifiers were introduced.
+    Entries created within the same second are disambiguated by the order in which they are read
+    */
+    if( !entry->hasId() )
+    {
+        const auto& entries( entryIndex() );
+        quint64 id( 0 );
+        for( int index = 0; index < LogEntry::LegacyIdCount && !id; ++index )
+        {
+            const auto legacyId( LogEntry::legacyId( entry->creation(), index ) );
+            if( !entries.find( legacyId ) ) id = legacyId;
+        }
+
+        entry->setId( id ? id:LogEntry::generateId() );
+        assignedIdEntries_.append( entry );
+    }
+
+    // free text memory
+    if( lazyLoading_ ) entry->unloadBody();
+
+    addEntry( entry );
+    emit progressAvailable( 1 );
+
+}
+
+//______________________________________________________________________
+void Logbook::_addChild( File file, const Summary& summary )
+{
+
+    if( !file.isAbsolute() ) file.addPath( Logbook::file_.path() );
+    LogbookPtr child( new Logbook );
+    child->setFile( file );
+    child->setUseCompression( useCompression_ );
+    child->setCodec( codec_ );
+    child->setUseSnapshot( useSnapshot_ );
+    child->setLazyLoading( lazyLoading_ );
+    child->setLoadedSince( loadedSince_ );
+    child->setManifestOnly( manifestOnly_ );
+    child->summary_ = summary;
+
+    // propagate progressAvailable signal.
+    connect( child.get(), &Logbook::progressAvailable, this, &Logbook::progressAvailable );
+    connect( child.get(), &Logbook::messageAvailable, this, &Logbook::messageAvailable );
+
+    // child content is read once this file is fully parsed
+    child->parent_ = this;
+    child->childIndex_ = children_.size();
+    children_.append( child );
+    monthChildren_.clear();
+
+}
+
+//______________________________________________________________________
+Logbook::LogbookPtr Logbook::_newChild()
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_newChild.\n") );
+
+    // file name. Children might have been removed, so make sure it is not in use
+    File file;
+    for( int index = children_.size();; ++index )
+    {
+        file = Local::childFileName( file_, index ).addPath( file_.path() );
+        if( std::none_of( children_.begin(), children_.end(), [&file]( const LogbookPtr& logbook ) { return logbook->file() == file; } ) )
+        { break; }
+    }
+
+    LogbookPtr logbook( new Logbook );
+    logbook->setTitle( title() );
+    logbook->setDirectory( directory() );
+    logbook->setAuthor( author() );
+    logbook->setFile( file );
+    logbook->setUseCompression( useCompression_ );
+    logbook->setCodec( codec_ );
+    logbook->setUseSnapshot( useSnapshot_ );
+    logbook->setLazyLoading( lazyLoading_ );
+    logbook->setModified( true );
+    logbook->parent_ = this;
+    logbook->childIndex_ = children_.size();
+    connect( logbook.get(), &Logbook::messageAvailable, this, &Logbook::messageAvailable );
+
+    children_.append( logbook );
+    setModified( true );
+
+    // associate to existing FileCheck if any
+    Base::KeySet<FileCheck> fileChecks( this );
+    if( !fileChecks.empty() )
+    { (*fileChecks.begin())->registerLogbook( logbook.get() ); }
+
+    return logbook;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_isFull( const Logbook& logbook ) const
+{
+
+    // unloaded children are considered full. They are reconsidered once loaded
+    if( !logbook.loaded_ ) return true;
+
+    if( sharding_.maxEntries > 0 && logbook.entryCount_ >= sharding_.maxEntries ) return true;
+    if( sharding_.maxSize > 0 && logbook.entrySize_ >= sharding_.maxSize ) return true;
+
+    return false;
+
+}
+
+//______________________________________________________________________
+Logbook::LogbookPtr Logbook::_monthChild( int month )
+{
+
+    // index children by the month of their entries. Children mixing several months, as written with other sharding, appear for each of them
+    if( monthChildren_.isEmpty() )
+    {
+        for( int index = 0; index < children_.size(); ++index )
+        {
+            const auto& logbook( children_[index] );
+            if( logbook->loaded_ )
+            {
+
+                for( const auto& entry:Base::KeySet<LogEntry>( logbook.get() ) )
+                {
+                    const auto entryMonth( Local::month( entry->creation() ) );
+                    if( !monthChildren_.contains( entryMonth ) ) monthChildren_.insert( entryMonth, index );
+                }
+
+            } else if( logbook->summary_.isValid() ) {
+
+                // unloaded children appear for all months in their recorded range
+                const auto last( Local::month( logbook->summary_.last ) );
+                for( auto entryMonth = Local::month( logbook->summary_.first ); entryMonth <= last; ++entryMonth )
+                { if( !monthChildren_.contains( entryMonth ) ) monthChildren_.insert( entryMonth, index ); }
+
+            }
+        }
+    }
+
+    const auto iter( monthChildren_.constFind( month ) );
+    if( iter != monthChildren_.constEnd() && iter.value() < children_.size() )
+    {
+        // make sure child is loaded before entries are added
+        const auto logbook( children_[iter.value()] );
+        logbook->_readUnloaded();
+        return logbook;
+    }
+
+    // add a new child if nothing found
+    auto logbook( _newChild() );
+    monthChildren_.insert( month, logbook->childIndex_ );
+    return logbook;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_readSnapshot( QDataStream& stream )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_readSnapshot.\n") );
+
+    // attributes
+    QString title;
+    QString directory;
+    QString author;
+    QString parentFile;
+    qint32 sortMethod( 0 );
+    qint32 sortOrder( 0 );
+    bool readOnly( false );
+    bool isBackup( false );
+    qint32 xmlEntries( 0 );
+    qint32 xmlChildren( 0 );
+    QString comments;
+    stream
+        >> title >> directory >> author >> parentFile
+        >> sortMethod >> sortOrder >> readOnly >> isBackup
+        >> xmlEntries >> xmlChildren >> comments;
+    if( stream.status() != QDataStream::Ok ) return false;
+
+    // empty values are skipped, consistently with xml
+    if( !title.isEmpty() ) setTitle( title );
+    if( !directory.isEmpty() ) setDirectory( File( directory ) );
+    if( !author.isEmpty() ) setAuthor( author );
+    if( !parentFile.isEmpty() ) setParentFile( File( parentFile ) );
+    setSortMethod( (SortMethod) sortMethod );
+    setSortOrder( sortOrder );
+    setReadOnly( readOnly );
+    setIsBackup( isBackup );
+    setXmlEntries( xmlEntries );
+    emit maximumProgressAvailable( xmlEntries );
+    setXmlChildren( xmlChildren );
+    if( !comments.isEmpty() ) setComments( comments );
+
+    // time stamps
+    const auto creation( Snapshot::readTimeStamp( stream ) );
+    if( creation.isValid() ) setCreation( creation );
+
+    const auto modification( Snapshot::readTimeStamp( stream ) );
+    if( modification.isValid() ) setModification( modification );
+
+    const auto backup( Snapshot::readTimeStamp( stream ) );
+    if( backup.isValid() ) setBackup( backup );
+
+    // recent entries
+    quint32 count( 0 );
+    stream >> count;
+    recentEntries_.clear();
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    {
+        quint64 id( 0 );
+        stream >> id;
+        recentEntries_.append( id );
+    }
+
+    // backup files
+    stream >> count;
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    {
+        QString file;
+        stream >> file;
+        const auto creation( Snapshot::readTimeStamp( stream ) );
+        backupFiles_.append( Backup( File( file ), creation ) );
+    }
+
+    // entries
+    stream >> count;
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    { _addEntry( new LogEntry( stream, !lazyLoading_ ) ); }
+
+    // children
+    stream >> count;
+    for( quint32 index = 0; index < count && stream.status() == QDataStream::Ok; ++index )
+    {
+        QString file;
+        qint32 entries( 0 );
+        quint32 keywordCount( 0 );
+        stream >> file >> entries;
+
+        Summary summary;
+        summary.entries = entries;
+        summary.first = Snapshot::readTimeStamp( stream );
+        summary.last = Snapshot::readTimeStamp( stream );
+        summary.modification = Snapshot::readTimeStamp( stream );
+        stream >> summary.hash >> keywordCount;
+        for( quint32 keywordIndex = 0; keywordIndex < keywordCount && stream.status() == QDataStream::Ok; ++keywordIndex )
+        {
+            QString keyword;
+            stream >> keyword;
+            summary.keywords.insert( Keyword( keyword ) );
+        }
+
+        _addChild( File( file ), summary );
+    }
+
+    return stream.status() == QDataStream::Ok;
+
+}
+
+//______________________________________________________________________
+void Logbook::_writeSnapshot( QDataStream& stream ) const
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_writeSnapshot.\n") );
+
+    // attributes
+    stream
+        << title_ << directory_.get() << author_ << parentFile_.get()
+        << qint32( Base::toIntegralType( sortMethod_ ) ) << qint32( sortOrder_ ) << readOnly_ << isBackup_
+        << qint32( xmlEntries_ ) << qint32( xmlChildren_ ) << comments_;
+
+    // time stamps
+    Snapshot::writeTimeStamp( stream, creation_ );
+    Snapshot::writeTimeStamp( stream, modification_ );
+    Snapshot::writeTimeStamp( stream, backup_ );
+
+    // recent entries
+    stream << quint32( recentEntries_.size() );
+    for( const auto& id:recentEntries_ )
+    { stream << id; }
+
+    // backup files
+    stream << quint32( backupFiles_.size() );
+    for( const auto& backup:backupFiles_ )
+    {
+        stream << backup.file().get();
+        Snapshot::writeTimeStamp( stream, backup.creation() );
+    }
+
+    // entries
+    const Base::KeySet<LogEntry> entries( this );
+    stream << quint32( entries.size() );
+    for( const auto& entry:entries )
+    { entry->writeSnapshot( stream ); }
+
+    // children, with same names and summaries as in xml
+    stream << quint32( children_.size() );
+    for( int childCount = 0; childCount < children_.size(); ++childCount )
+    {
+        const auto& summary( children_[childCount]->summary_ );
+        stream << Local::childFileName( file_, childCount ).get() << qint32( summary.entries );
+        Snapshot::writeTimeStamp( stream, summary.first );
+        Snapshot::writeTimeStamp( stream, summary.last );
+        Snapshot::writeTimeStamp( stream, summary.modification );
+        stream << summary.hash << quint32( summary.keywords.size() );
+        for( const auto& keyword:summary.keywords )
+        { stream << keyword.get(); }
+    }
+
+}
+
+//______________________________________________________________________
+void Logbook::_updateSnapshot( const Snapshot::Signature& signature )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_updateSnapshot.\n") );
+
+    // serialize on this thread, since entries are not thread safe
+    QByteArray payload;
+    QDataStream stream( &payload, QIODevice::WriteOnly );
+    Snapshot::setup( stream );
+    _writeSnapshot( stream );
+
+    // check and write in the background
+    QtConcurrent::run( Snapshot::write, file_, payload, signature );
+
+}
+
+//______________________________________________________________________
+bool Logbook::_prepareWrite( const File& file, WriteTask::List& tasks )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_prepareWrite.\n") );
+
+    // unloaded children are left untouched, unless written to a new file
+    if( !loaded_ && file != file_ && !_readUnloaded() )
+    {
+        Debug::Throw(0) << "Logbook::write - unable to read " << file_ << ", needed to write " << file << Qt::endl;
+        return false;
+    }
+
+    if( !loaded_ )
+    {
+        WriteTask task;
+        task.logbook = this;
+        task.file = file;
+        tasks.append( task );
+        return true;
+    }
+
+    // check number of entries and children to save in header
+    const bool countChanged( setXmlEntries( entries().size() + _unloadedEntryCount() ) || setXmlChildren( children().size() ) );
+    if( countChanged ) setModified( true );
+
+    // check children summaries, as recorded in header
+    if( _updateSummaries() ) setModified( true );
+
+    /*
+    children are flagged modified whenever one of their entries might have changed.
+    Their header is not edited otherwise, so that they need not be written when none of their entries actually has.
+    */
+    const bool isChild( !tasks.empty() );
+    if( isChild && modified_ && file == file_ && !countChanged && !_hasChanges() )
+    {
+        Debug::Throw() << "Logbook::_prepareWrite - skipping unchanged file " << file_ << Qt::endl;
+        modified_ = false;
+    }
+
+    emit maximumProgressAvailable( xmlEntries() );
+
+    WriteTask task;
+    task.logbook = this;
+    task.file = file;
+
+    // write logbook if filename differs from origin or logbook is modified
+    if( file != file_ || modified_ )
+    {
+
+        task.isNeeded = true;
+
+        // gets last saved timestamp
+        task.lastSaved = file.lastModified();
+
+        // symbolic links are kept, and their target replaced
+        const auto canonical( QFileInfo( file ).canonicalFilePath() );
+        task.target = canonical.isEmpty() ? file:File( canonical );
+        task.temporary = Local::temporaryFile( task.target );
+
+        // make a backup of the file, if necessary
+        if( XmlOptions::get().get<bool>( QStringLiteral("FILE_BACKUP") ) )
+        { File( file ).backup(); }
+
+    } else { emit progressAvailable( Base::KeySet<LogEntry>( this ).size() ); }
+
+    tasks.append( task );
+
+    // children
+    int childCount=0;
+    for( const auto& logbook:children_ )
+    {
+
+        File childFileName( Local::childFileName( file, childCount ).addPath( file.path() ) );
+
+        logbook->setParentFile( file );
+        if( !logbook->_prepareWrite( childFileName, tasks ) ) return false;
+
+        ++childCount;
+
+    }
+
+    return true;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_writeFile( const WriteTask& task )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_writeFile.\n") );
+
+    // open output file
+    QFile out( task.temporary );
+    if( !out.open( QIODevice::WriteOnly ) )
+    {
+        Debug::Throw(0) << "Logbook::write - unable to write to file " << task.temporary << Qt::endl;
+        return false;
+    }
+
+    // codecs other than zlib compress the serialized content in one go
+    const auto codec( _codec() );
+    if( codec != FileFormat::Codec::None && codec != FileFormat::Codec::Zlib )
+    {
+        const auto data( FileFormat::encode( _serialize( task.file ), codec ) );
+        return out.write( data ) == data.size() && out.flush();
+    }
+
+    // compress on the fly if needed, to avoid intermediate copies of the content
+    DeflateDevice deflateDevice( &out );
+    QIODevice* device( &out );
+    if( codec == FileFormat::Codec::Zlib )
+    {
+        out.write( FileFormat::header( FileFormat::Codec::Zlib ) );
+        if( deflateDevice.open( QIODevice::WriteOnly ) ) device = &deflateDevice;
+        else {
+
+            // fallback to uncompressed content, with no header
+            Debug::Throw(0) << "Logbook::write - unable to initialize compression for file " << task.file << Qt::endl;
+            out.seek( 0 );
+            out.resize( 0 );
+
+        }
+    }
+
+    // write
+    QXmlStreamWriter writer( device );
+    writer.setAutoFormatting( true );
+    writer.setAutoFormattingIndent( 1 );
+    _writeXml( writer, task.file );
+
+    /*
+    finish. Errors while flushing compressed data, writing the size header, or flushing the file
+    would otherwise leave a truncated file, moved in place of the valid one
+    */
+    bool success( !writer.hasError() );
+    if( device == &deflateDevice && !deflateDevice.finish() ) success = false;
+    if( !out.flush() || out.error() != QFileDevice::NoError ) success = false;
+    out.close();
+
+    if( !success ) Debug::Throw(0) << "Logbook::write - unable to write to file " << task.temporary << Qt::endl;
+    return success;
+
+}
+
+//______________________________________________________________________
+QByteArray Logbook::_serialize( const File& file )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_serialize.\n") );
+
+    QByteArray out;
+    QBuffer buffer( &out );
+    buffer.open( QIODevice::WriteOnly );
+
+    QXmlStreamWriter writer( &buffer );
+    writer.setAutoFormatting( true );
+    writer.setAutoFormattingIndent( 1 );
+    _writeXml( writer, file );
+
+    return out;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_commitWrite( const WriteTask& task, WriteStatistics& statistics )
+{
+
+    bool completed( true );
+    if( task.isNeeded )
+    {
+
+        // gets/check new saved timestamp
+        TimeStamp savedNew( task.file.lastModified() );
+        if( !( task.lastSaved < savedNew ) ) completed = false;
+        else if( task.file == file_ )  modified_ = false;
+
+        // assign new filename
+        if( task.file != file_ ) setFile( task.file );
+
+        // statistics
+        ++statistics.files;
+        statistics.bytes += file_.fileSize();
+
+        // entries are now saved
+        if( completed ) _clearChanges();
+
+        // regenerate snapshot
+        if( completed && useSnapshot_ ) _updateSnapshot( Snapshot::signature( file_ ) );
+
+    }
+
+    // update saved timeStamp
+    saved_ = file_.lastModified();
+    return completed;
+
+}
+
+//______________________________________________________________________
+bool Logbook::_hasChanges() const
+{
+
+    const Base::KeySet<LogEntry> entries( this );
+    if( entries.size() != savedEntries_.size() ) return true;
+
+    // new entries are dirty, so that a new entry allocated in place of a deleted one is also detected
+    return std::any_of( entries.begin(), entries.end(), [this]( const LogEntry* entry )
+        { return entry->isDirty() || !savedEntries_.contains( entry ); } );
+
+}
+
+//______________________________________________________________________
+void Logbook::_keepAssignedIds()
+{
+
+    // entries with newly assigned identifiers are kept as changes, for identifiers to be persisted on next save
+    if( assignedIdEntries_.empty() ) return;
+    for( const auto& entry:assignedIdEntries_ )
+    { savedEntries_.remove( entry ); }
+
+    assignedIdEntries_.clear();
+    setModified( true );
+
+}
+
+//______________________________________________________________________
+void Logbook::_clearChanges()
+{
+
+    savedEntries_.clear();
+    journalEntries_.clear();
+    for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+    {
+        entry->setDirty( false );
+        savedEntries_.insert( entry );
+        journalEntries_.insert( entry, Local::removeRecord( entry ) );
+    }
+
+}
+
+//______________________________________________________________________
+void Logbook::_collectJournal( Journal::Record::List& removed, Journal::Record::List& written ) const
+{
+
+    // added and modified entries
+    QSet<const LogEntry*> entries;
+    for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+    {
+        entries.insert( entry );
+        if( journalEntries_.contains( entry ) && !( entry->isDirty() && !entry->isJournaled() ) ) continue;
+
+        Journal::Record record;
+        record.action = Journal::Action::Write;
+        record.id = entry->id();
+        record.creation = entry->creation();
+
+        QDataStream stream( &record.data, QIODevice::WriteOnly );
+        Snapshot::setup( stream );
+        entry->writeSnapshot( stream );
+        written.append( record );
+    }
+
+    // removed entries
+    for( auto&& iter = journalEntries_.begin(); iter != journalEntries_.end(); ++iter )
+    {
+        if( entries.contains( iter.key() ) ) continue;
+        removed.append( iter.value() );
+    }
+
+    for( const auto& logbook:children_ )
+    { logbook->_collectJournal( removed, written ); }
+
+}
+
+//______________________________________________________________________
+void Logbook::_commitJournal()
+{
+
+    journalEntries_.clear();
+    for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+    {
+        if( entry->isDirty() ) entry->setJournaled( true );
+        journalEntries_.insert( entry, Local::removeRecord( entry ) );
+    }
+
+    for( const auto& logbook:children_ )
+    { logbook->_commitJournal(); }
+
+}
+
+//______________________________________________________________________
+void Logbook::_replayJournal()
+{
+
+    const auto records( Journal::read( file_ ) );
+    if( records.empty() ) return;
+
+    Debug::Throw() << "Logbook::_replayJournal - " << records.size() << " records" << Qt::endl;
+
+    // load children possibly holding journaled entries
+    QList<TimeStamp> timeStamps;
+    for( const auto& record:records )
+    { timeStamps.append( record.creation ); }
+    loadChildren( timeStamps );
+
+    // entries by identifier. The index is updated as entries are added and deleted
+    const auto& entries( entryIndex() );
+    for( const auto& record:records )
+    {
+
+        // remove existing entry, if any, keeping track of its logbook
+        Logbook* logbook( nullptr );
+        auto existing( entries.find( record.id ) );
+        if( existing )
+        {
+            for( const auto& parent:Base::KeySet<Logbook>( existing ) )
+            {
+                parent->setModified( true );
+                logbook = parent;
+            }
+
+            delete existing;
+        }
+
+        if( record.action != Journal::Action::Write ) continue;
+
+        // add new entry
+        QDataStream stream( record.data );
+        Snapshot::setup( stream );
+        auto entry( new LogEntry( stream ) );
+        if( stream.status() != QDataStream::Ok )
+        {
+            Debug::Throw(0) << "Logbook::_replayJournal - invalid entry record" << Qt::endl;
+            delete entry;
+            continue;
+        }
+
+        if( !logbook ) logbook = childFor( entry ).get();
+        logbook->_addEntry( entry );
+        logbook->setModified( true );
+
+    }
+
+    // replayed entries are already in the journal
+    _commitJournal();
+
+}
+
+//______________________________________________________________________
+void Logbook::_writeXml( QXmlStreamWriter& writer, const File& file )
+{
+
+    Debug::Throw( QStringLiteral("Logbook::_writeXml.\n") );
+
+    // main element
+    writer.writeStartElement( Xml::Logbook );
+    if( !title_.isEmpty() ) writer.writeAttribute( Xml::Title, title_ );
+    if( !directory_.isEmpty() ) writer.writeAttribute( Xml::Directory, directory_.get() );
+    if( !author_.isEmpty() ) writer.writeAttribute( Xml::Author, author_ ) ;
+    if( !parentFile_.isEmpty() ) writer.writeAttribute( Xml::ParentFile, parentFile_.get() );
+
+    writer.writeAttribute( Xml::SortMethod, QString::number( Base::toIntegralType( sortMethod_ ) ) );
+    writer.writeAttribute( Xml::SortOrder, QString::number( sortOrder_ ) );
+    writer.writeAttribute( Xml::ReadOnly, QString::number( readOnly_ ) );
+    writer.writeAttribute( Xml::BackupMask, QString::number( isBackup_ ) );
+
+    // update number of entries and children
+    writer.writeAttribute( Xml::Entries, QString::number(xmlEntries()) );
+    writer.writeAttribute( Xml::Children, QString::number(xmlChildren()) );
+
+    // comments
+    if( comments().size() ) writer.writeTextElement( Xml::Comments, comments() );
+
+    // write time stamps
+    QDomDocument document;
+    if( creation().isValid() ) XmlStreamUtil::writeElement( writer, XmlTimeStamp( creation() ).domElement( Xml::Creation, document ) );
+    if( modification().isValid() ) XmlStreamUtil::writeElement( writer, XmlTimeStamp( modification() ).domElement( Xml::Modification, document ) );
+    if( backup().isValid() ) XmlStreamUtil::writeElement( writer, XmlTimeStamp( backup() ).domElement( Xml::Backup, document ) );
+
+    // write recent entries
+    if( !recentEntries_.empty() ) _writeRecentEntries( writer );
+
+    // write backup files
+    for( const auto& backup:backupFiles_ )
+    { backup.writeXml( writer ); }
+
+    // write all entries
+    for( const auto& entry:Base::KeySet<LogEntry>( this ) )
+    {
+        entry->writeXml( writer );
+        emit progressAvailable( 1 );
+    }
+
+    // dump all logbook childrens, with their summary, used to skip reading children out of loaded range
+    for( int childCount = 0; childCount < children_.size(); ++childCount )
+    {
+        const auto& summary( children_[childCount]->summary_ );
+        writer.writeStartElement( Xml::Child );
+        writer.writeAttribute( Xml::File, Local::childFileName( file, childCount ).get() );
+        if( summary.isValid() )
+        {
+            writer.writeAttribute( Xml::Entries, QString::number( summary.entries ) );
+            writer.writeAttribute( Xml::FirstCreation, QString::number( summary.first.unixTime() ) );
+            writer.writeAttribute( Xml::LastCreation, QString::number( summary.last.unixTime() ) );
+            writer.writeAttribute( Xml::LastModification, QString::number( summary.modification.unixTime() ) );
+            writer.writeAttribute( Xml::Hash, QString::number( summary.hash, 16 ) );
+            for( const auto& keyword:summary.keywords )
+            { keyword.writeXml( writer ); }
+        }
+
+        writer.writeEndElement();
+    }
+
+    writer.writeEndElement();
+
+}
+
+//______________________________________________________________________
+void Logbook::_writeRecentEntries( QXmlStreamWriter& writer ) const
+{
+    Debug::Throw( QStringLiteral("Logbook::_writeRecentEntries.\n") );
+
+    writer.writeStartElement( Xml::RecentEntries );
+    for( const auto& id:recentEntries_ )
+    {
+        writer.writeStartElement( Xml::Entry );
+        writer.writeAttribute( Xml::Id, QString::number( id, 16 ) );
+        writer.writeEndElement();
+    }
+    writer.writeEndElement();
 
 }
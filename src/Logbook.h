@@ -23,19 +23,29 @@
 #include "Backup.h"
 #include "Counter.h"
 #include "Debug.h"
+#include "EntryIndex.h"
 #include "File.h"
+#include "FileFormat.h"
 #include "Functors.h"
 #include "IntegralType.h"
+#include "Journal.h"
 #include "Key.h"
+#include "Keyword.h"
+#include "KeywordIndex.h"
+#include "Snapshot.h"
 #include "TimeStamp.h"
 #include "XmlError.h"
 
+#include <QDataStream>
 #include <QDomElement>
 #include <QDomDocument>
 
 #include <QHash>
 #include <QList>
 #include <QObject>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
 #include <memory>
 
@@ -67,9 +77,28 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* default string when no directory given
     static const QString NoDirectory;
 
-    //* max number of entries in logbook (make child logbook if larger)
+    //* default max number of entries in logbook (make child logbook if larger)
     enum { MaxEntries = 50 };
 
+    //* distribution of entries among children files
+    class Sharding
+    {
+        public:
+
+        //* sharding from options
+        static Sharding fromOptions();
+
+        //* max number of entries per child. Zero means unlimited
+        int maxEntries = MaxEntries;
+
+        //* max size of entries content per child, in bytes. Zero means unlimited
+        qint64 maxSize = 0;
+
+        //* when set, entries are grouped by creation month, one child per month, and limits are ignored
+        bool byMonth = false;
+
+    };
+
     //* configuration mask
     enum MaskFlag
     {
@@ -111,21 +140,55 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* retrieves list of all child logbook [recursive]
     List children() const;
 
-    //* retrieves first not full child.
+    //* retrieves first not full child. A new child is created if needed
+    /**
+    it runs in constant amortized time, using the children entry count and the position of the first child that might not be full.
+    When sharding by month, the child matching current month is returned
+    */
     LogbookPtr latestChild();
 
+    //* retrieves child to which given entry is to be added. A new child is created if needed
+    /** when sharding by month, the child matching the entry creation month is returned. Otherwise this is the latest child */
+    LogbookPtr childFor( const LogEntry* );
+
     //* retrieve all associated entries [recursive]
+    /** the set is maintained incrementally when entries are added, removed or deleted */
     Base::KeySet<LogEntry> entries() const;
 
+    //* entries indexed by identifier [recursive]
+    /** the index is maintained by the top-level logbook */
+    const EntryIndex& entryIndex() const
+    { return _root().entryIndex_; }
+
+    //* entries indexed by keyword [recursive]
+    /** the index is maintained by the top-level logbook */
+    const KeywordIndex& keywordIndex() const
+    { return _root().keywordIndex_; }
+
     //* recent entries
     QList<LogEntry*> recentEntries() const;
 
     //* retrieve all associated attachments [recursive]
     Base::KeySet<Attachment> attachments() const;
 
-    //* returns true if logbook is empty (no recursive entries found)
+    //* number of entries directly associated to this logbook
+    int entryCount() const
+    { return entryCount_; }
+
+    //* returns true if logbook is empty (no recursive entries found, and nothing left unloaded)
     bool empty() const
-    { return entries().empty(); }
+    { return loaded_ && entries().empty() && !hasUnloadedChildren(); }
+
+    //* true if logbook file content has been read
+    /** children whose entries are older than the loaded range are not read until needed */
+    bool isLoaded() const
+    { return loaded_; }
+
+    //* true if some children are not loaded [recursive]
+    bool hasUnloadedChildren() const;
+
+    //* keywords of entries in unloaded children, as recorded in parent file [recursive]
+    Keyword::Set unloadedKeywords() const;
 
     //* logbook filename
     const File& file() const
@@ -158,6 +221,10 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* tells if logbook or children has been modified since last call [recursive]
     bool modified() const;
 
+    //* true if changes have been journaled since logbook files were last written
+    bool hasJournal() const
+    { return !file_.isEmpty() && Journal::file( file_ ).exists(); }
+
     //* read only
     bool isReadOnly() const
     { return readOnly_; }
@@ -226,6 +293,85 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     const Backup::List& backupFiles() const
     { return backupFiles_; }
 
+    //* write statistics
+    class WriteStatistics
+    {
+        public:
+
+        //* number of files written
+        int files = 0;
+
+        //* number of bytes written
+        qint64 bytes = 0;
+
+        //* time spent serializing and writing to temporary files (ms)
+        qint64 writeTime = 0;
+
+        //* time spent syncing temporary files to disk (ms)
+        qint64 syncTime = 0;
+
+        //* time spent moving files in place and syncing directories (ms)
+        qint64 renameTime = 0;
+
+    };
+
+    //* statistics about last write
+    const WriteStatistics& writeStatistics() const
+    { return writeStatistics_; }
+
+    //* synchronization conflict
+    /** it is reported when the same field group has been modified differently on both sides */
+    class Conflict
+    {
+        public:
+
+        //* list
+        using List = QList<Conflict>;
+
+        //* entry creation time stamp
+        TimeStamp creation;
+
+        //* entry title
+        QString title;
+
+        //* conflicting field groups, as a combination of LogEntry::GroupFlag
+        int groups = 0;
+
+        //* true if both entries derive from a common synchronized version
+        /** otherwise all differing groups are conflicting */
+        bool hasBase = false;
+
+        //* true if remote field groups were kept, because remote entry is more recently modified
+        bool remoteKept = false;
+
+    };
+
+    //* synchronization statistics
+    class SynchronizeStatistics
+    {
+        public:
+
+        //* number of remote entries added, with no local match
+        int added = 0;
+
+        //* number of local entries replaced by remote entry
+        int replaced = 0;
+
+        //* number of local entries merged with non overlapping remote changes
+        int merged = 0;
+
+        //* number of remote entries skipped, since identical or already merged locally
+        int skipped = 0;
+
+        //* conflicts
+        Conflict::List conflicts;
+
+    };
+
+    //* statistics about last synchronization
+    const SynchronizeStatistics& synchronizeStatistics() const
+    { return synchronizeStatistics_; }
+
     //@}
 
     //*@name modifiers
@@ -234,6 +380,80 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* compression [recursive]
     void setUseCompression( bool value );
 
+    //* compression codec, used when compression is enabled [recursive]
+    void setCodec( FileFormat::Codec );
+
+    //* binary snapshots [recursive]
+    /**
+    when set, a binary snapshot is loaded in place of each file xml content, provided that it matches the file.
+    Snapshots are regenerated in the background after the file is read from xml or written.
+    */
+    void setUseSnapshot( bool );
+
+    //* lazy loading [recursive]
+    /** when set, entries text and formats are moved to body store when read, and loaded on demand */
+    void setLazyLoading( bool );
+
+    //* journal
+    /**
+    when set, entry changes can be appended to a journal next to the logbook file, in place of writing the logbook files.
+    It is only used by the top-level logbook. The journal is replayed when reading, whether set or not
+    */
+    void setUseJournal( bool value )
+    { useJournal_ = value; }
+
+    //* sharding
+    /**
+    it is only used by the top-level logbook, to select the child to which new entries are added.
+    Existing children are left untouched, unless reorganized
+    */
+    void setSharding( const Sharding& value )
+    {
+        sharding_ = value;
+        firstNonFull_ = 0;
+        monthChildren_.clear();
+    }
+
+    //* loaded range [recursive]
+    /**
+    when set, children whose entries have all been created before given time stamp,
+    as recorded in the parent file, are not read. They are loaded on demand,
+    or when needed to write them to a new file, to synchronize or to replay the journal.
+    Children with no recorded range, as written by previous versions, are always read
+    */
+    void setLoadedSince( const TimeStamp& );
+
+    //* manifest only [recursive]
+    /**
+    when set, children with a summary recorded in the parent file are not read.
+    They are loaded on demand, same as children out of loaded range. This is used for synchronization
+    */
+    void setManifestOnly( bool );
+
+    //* read unloaded children [recursive]. Returns true if any was loaded
+    bool loadChildren();
+
+    //* read unloaded children with entries matching given keyword [recursive]. Returns true if any was loaded
+    bool loadChildren( const Keyword& );
+
+    //* read unloaded children whose range contains given creation time stamp [recursive]. Returns true if any was loaded
+    bool loadChildren( const TimeStamp& );
+
+    //* read unloaded children whose range contains any of given creation time stamps [recursive]. Returns true if any was loaded
+    bool loadChildren( QList<TimeStamp> );
+
+    //* read most recent unloaded child [recursive]. Returns true if any was loaded
+    bool loadPreviousChild();
+
+    //* parallel write
+    /**
+    when set, children files are compressed and written concurrently.
+    Their content is then serialized in memory rather than streamed to file,
+    trading a bounded amount of memory for speed
+    */
+    void setParallelWrite( bool value )
+    { parallelWrite_ = value; }
+
     //* read from file
     /**
     reads all xml based objects in the input file and chlids,
@@ -241,16 +461,57 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     */
     bool read();
 
+    //* read several logbooks, their top-level files being read and uncompressed concurrently
+    /** returns the logbooks that could not be read */
+    static QList<Logbook*> readAll( const QList<Logbook*>& );
+
     //* writes all xml based objects in given|input file, if any [recursive]
+    /**
+    children files are only rewritten when their list of entries has changed,
+    or when any of their entries is dirty, even if they are flagged as modified
+    */
     bool write( File = File() );
 
+    //* append entries added, modified or removed since last read, write or journal to the journal [recursive]
+    /**
+    returns false if journal is disabled, if the logbook file does not exist yet or if the journal is too large,
+    in which case the logbook files must be written instead
+    */
+    bool writeJournal();
+
+    //* associate entry to this logbook
+    /** entries must be associated and disassociated through these methods, for cached entries to remain valid */
+    void addEntry( LogEntry* );
+
+    //* disassociate entry from this logbook
+    void removeEntry( LogEntry* );
+
+    //* disassociate all entries from this logbook
+    void clearEntries();
+
+    //* update keyword index when keyword is added to associated entry
+    void addEntryKeyword( LogEntry*, const Keyword& );
+
+    //* update keyword index when keyword is removed from associated entry
+    void removeEntryKeyword( LogEntry*, const Keyword& );
+
+    //* update size of entries when associated entry size changes
+    void updateEntrySize( LogEntry*, qint64 );
+
     //* synchronize logbook with remote
     /**
     returns a map of duplicated entries.
     The first entry is local and can be safely deleted
-    The second entry is the remote replacement
+    The second entry is its replacement in this logbook.
+    Entries are matched on creation time in a single pass, and compared using their content hashes.
+    Field groups modified on one side only since the last synchronization are merged.
+    Groups modified on both sides are taken from the most recently modified entry, and reported as conflicts.
+    Only entries of this logbook are modified, so that the same remote logbook can be merged into several ones.
+    Children with matching summary hash on both sides hold the same entries and are skipped.
+    Unloaded children are loaded on both sides otherwise.
+    When the remote logbook has no children, only children that might hold its entries are loaded
     */
-    QHash<LogEntry*,LogEntry*> synchronize( const Logbook& logbook );
+    QHash<LogEntry*,LogEntry*> synchronize( Logbook& logbook );
 
     //* truncate recent entries list
     void truncateRecentEntriesList( int );
@@ -420,15 +681,256 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
 
     private:
 
+    //* pending file write
+    class WriteTask
+    {
+        public:
+
+        //* list
+        using List = QList<WriteTask>;
+
+        //* logbook
+        Logbook* logbook = nullptr;
+
+        //* destination file
+        File file;
+
+        //* destination file, with symbolic links resolved. It is the file actually replaced
+        File target;
+
+        //* temporary file, created next to target, and moved to target once written and synced
+        File temporary;
+
+        //* last saved timestamp of destination, prior to writing
+        TimeStamp lastSaved;
+
+        //* true if file needs to be written
+        bool isNeeded = false;
+
+    };
+
+    //* child content summary, as recorded in parent file. It serves as a manifest for partial open and synchronization
+    class Summary
+    {
+        public:
+
+        //* true if range is set
+        bool isValid() const
+        { return first.isValid() && last.isValid(); }
+
+        //* equal to operator
+        bool operator == ( const Summary& ) const;
+
+        //* merge other summary
+        void merge( const Summary& );
+
+        //* number of entries
+        int entries = 0;
+
+        //* creation of first entry
+        TimeStamp first;
+
+        //* creation of last entry
+        TimeStamp last;
+
+        //* last modification of entries
+        TimeStamp modification;
+
+        //* hash of entries creation and modification time stamps
+        /** it does not depend on entries order, so that summaries can be merged */
+        quint64 hash = 0;
+
+        //* entries keywords
+        Keyword::Set keywords;
+
+    };
+
+    //* file content, as read from disk
+    class Content
+    {
+        public:
+
+        //* true if file could be read
+        bool isValid = false;
+
+        //* uncompressed xml content. It is left empty when a matching snapshot is found
+        QByteArray data;
+
+        //* snapshot payload, if any
+        QByteArray snapshot;
+
+        //* file signature
+        Snapshot::Signature signature;
+
+        //* error message, if any
+        QString error;
+
+    };
+
+    //* read and uncompress file content, or matching snapshot if requested
+    /** this is safe to be called from worker threads */
+    static Content _readContent( const File&, bool useSnapshot );
+
+    //* effective codec used for writing
+    FileFormat::Codec _codec() const
+    { return useCompression_ ? codec_:FileFormat::Codec::None; }
+
+    //* collect logbook and children to be written [recursive]
+    /** returns false if an unloaded child cannot be read, when writing to a new file */
+    bool _prepareWrite( const File&, WriteTask::List& );
+
+    //* write logbook file, compressing on the fly if needed
+    bool _writeFile( const WriteTask& );
+
+    //* serialize logbook content to uncompressed buffer
+    QByteArray _serialize( const File& );
+
+    //* update modified flag and saved timestamp after write, and update statistics. Returns true if completed
+    bool _commitWrite( const WriteTask&, WriteStatistics& );
+
+    //* true if entries have been added, removed or modified since last read or write
+    bool _hasChanges() const;
+
+    //* store current list of entries and mark them as not dirty, after read or write
+    void _clearChanges();
+
+    //* keep entries with identifiers assigned while parsing as changes, for these to be saved
+    void _keepAssignedIds();
+
+    //* collect journal records for entries removed, added or modified since last journal [recursive]
+    void _collectJournal( Journal::Record::List& removed, Journal::Record::List& written ) const;
+
+    //* store current list of entries and mark them as journaled [recursive]
+    void _commitJournal();
+
+    //* apply journal records to entries, after read
+    void _replayJournal();
+
+    //* parse file content, from snapshot or xml, then read children
+    bool _load( const Content& );
+
+    //* load content read from file, and replay journal
+    bool _read( const Content& );
+
+    //* parse uncompressed file content, then read children
+    bool _parse( const QByteArray& );
+
+    //* parse snapshot payload, then read children
+    bool _parseSnapshot( const QByteArray& );
+
+    //* read logbook content from snapshot
+    bool _readSnapshot( QDataStream& );
+
+    //* write logbook content to snapshot
+    void _writeSnapshot( QDataStream& ) const;
+
+    //* generate snapshot and write it in the background, provided that the file still matches signature
+    void _updateSnapshot( const Snapshot::Signature& );
+
+    //* create new child and append to children list
+    LogbookPtr _newChild();
+
+    //* true if child cannot receive more entries, depending on sharding
+    bool _isFull( const Logbook& ) const;
+
+    //* child matching given month, created if needed
+    LogbookPtr _monthChild( int );
+
+    //* read children files, in parallel. Children out of loaded range are skipped
+    void _readChildren( const List& );
+
+    //* read file content of unloaded child. Returns true on success
+    bool _readUnloaded();
+
+    //* read unloaded children matching predicate [recursive]. Returns true if any was loaded
+    template<class Predicate>
+    bool _loadChildren( Predicate );
+
+    //* summary of entries and unloaded children [recursive]
+    Summary _summary() const;
+
+    //* update recorded summary of loaded children. Returns true if changed
+    bool _updateSummaries();
+
+    //* number of entries in unloaded children, as recorded in parent file [recursive]
+    int _unloadedEntryCount() const;
+
+    //* summary hash of children, recorded or computed
+    QSet<quint64> _childrenHashes() const;
+
+    //* top-level logbook
+    const Logbook& _root() const
+    { return parent_ ? parent_->_root():*this; }
+
+    //* top-level logbook
+    Logbook& _root()
+    { return parent_ ? parent_->_root():*this; }
+
+    //* read logbook content from xml stream, positioned on the top-level element
+    bool _read( QXmlStreamReader& );
+
     //* read recent entries
-    void _readRecentEntries( const QDomElement& );
+    void _readRecentEntries( QXmlStreamReader& );
 
-    //* recent entries dom element
-    QDomElement _recentEntriesElement( QDomDocument& ) const;
+    //* add entry read from file
+    void _addEntry( LogEntry* );
+
+    //* add child read from file, with its summary as recorded, if any
+    void _addChild( File, const Summary& = Summary() );
+
+    //* write logbook content to xml stream. File is used for children file names
+    void _writeXml( QXmlStreamWriter&, const File& );
+
+    //* write recent entries
+    void _writeRecentEntries( QXmlStreamWriter& ) const;
 
     //* list of pointers to logbook children
     List children_;
 
+    //* parent logbook, if any
+    Logbook* parent_ = nullptr;
+
+    //* entries indexed by identifier, for top-level logbook
+    EntryIndex entryIndex_;
+
+    //* entries indexed by keyword, for top-level logbook
+    KeywordIndex keywordIndex_;
+
+    //* position in parent children list
+    int childIndex_ = 0;
+
+    //* number of entries directly associated to this logbook
+    int entryCount_ = 0;
+
+    //* approximate size of entries directly associated to this logbook, in bytes
+    /** it is used for sharding, to avoid summing entry sizes on each insertion */
+    qint64 entrySize_ = 0;
+
+    //* entries read without identifier, that have been assigned one since the file was parsed
+    QList<const LogEntry*> assignedIdEntries_;
+
+    //* position of first child that might not be full. All children before are full
+    int firstNonFull_ = 0;
+
+    //* sharding
+    Sharding sharding_;
+
+    //* true if file content has been read
+    bool loaded_ = true;
+
+    //* children entirely created before this time stamp are not read, if set
+    TimeStamp loadedSince_;
+
+    //* true if children with recorded summary are not read
+    bool manifestOnly_ = false;
+
+    //* summary, as recorded in parent file or last written
+    Summary summary_;
+
+    //* position of children in list, indexed by the month of their entries
+    /** it is used when sharding by month, and rebuilt when empty */
+    QHash<int, int> monthChildren_;
+
     //* file from which the logbook entries are read
     File file_;
 
@@ -459,6 +961,21 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* true if logbook uses compression
     bool useCompression_ = false;
 
+    //* compression codec
+    FileFormat::Codec codec_ = FileFormat::defaultCodec();
+
+    //* true if children are written concurrently
+    bool parallelWrite_ = false;
+
+    //* true if binary snapshots are used
+    bool useSnapshot_ = false;
+
+    //* true if entries text and formats are loaded on demand
+    bool lazyLoading_ = false;
+
+    //* true if entry changes are journaled
+    bool useJournal_ = false;
+
     //* logbook creation time
     TimeStamp creation_;
 
@@ -477,13 +994,12 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* backup list
     Backup::List backupFiles_;
 
-    //* list of recent entries
-    /** creation time stamp of recent entries are stored */
-    using TimeStampList = QList<TimeStamp>;
+    //* list of entry identifiers
+    using IdList = QList<quint64>;
 
     //* list of recent entries
-    /** creation time stamp of recent entries are stored */
-    TimeStampList recentEntries_;
+    /** identifiers of recent entries are stored */
+    IdList recentEntries_;
 
     //* sort order
     int sortOrder_ = 0;
@@ -505,6 +1021,22 @@ class Logbook:public QObject, private Base::Counter<Logbook>, public Base::Key
     //* error when parsing xml file
     XmlError error_;
 
+    //* entries [recursive]
+    /** they are maintained by this logbook and its children, when entries are added or removed */
+    Base::KeySet<LogEntry> entries_;
+
+    //* entries as last read or written
+    QSet<const LogEntry*> savedEntries_;
+
+    //* entries as last read, written or journaled, with the journal record used to remove them
+    QHash<const LogEntry*, Journal::Record> journalEntries_;
+
+    //* statistics about last write
+    WriteStatistics writeStatistics_;
+
+    //* statistics about last synchronization
+    SynchronizeStatistics synchronizeStatistics_;
+
 };
 
 #endif
@@ -214,7 +214,7 @@ void LogbookHtmlHelper::_appendTable( QDomDocument& document, QDomElement& paren
         // title
         QDomElement ref = row.appendChild( document.createElement( QStringLiteral("td") ) ).
             appendChild( document.createElement( QStringLiteral("a") ) ).toElement();
-        ref.setAttribute( QStringLiteral("href"), QStringLiteral( "#" ) + QString::number( entry->creation().unixTime() ) );
+        ref.setAttribute( QStringLiteral("href"), QStringLiteral( "#" ) + QString::number( entry->id(), 16 ) );
         ref.appendChild( document.createTextNode( entry->title().toUtf8() ) );
 
         // keywords
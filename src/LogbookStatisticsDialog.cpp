@@ -18,6 +18,7 @@
 *******************************************************************************/
 
 #include "LogbookStatisticsDialog.h"
+#include "BodyStore.h"
 #include "Debug.h"
 #include "GridLayout.h"
 #include "GridLayoutItem.h"
@@ -33,6 +34,7 @@
 #include <QHeaderView>
 #include <QLayout>
 #include <QLabel>
+#include <QLocale>
 #include <QPushButton>
 
 //_________________________________________________________
@@ -104,6 +106,29 @@ LogbookStatisticsDialog::LogbookStatisticsDialog( QWidget* parent, Logbook* logb
     item->setKey( tr( "Attachments:" ) );
     item->setText( QString::number( logbook->attachments().size() ) );
 
+    // entries text memory
+    const auto& statistics( BodyStore::get().statistics() );
+    if( BodyStore::get().budget() > 0 )
+    {
+        item = new GridLayoutItem( this, gridLayout );
+        item->setKey( tr( "Text in memory:" ) );
+        item->setText( tr( "%1 in %2 entries (budget: %3)" )
+            .arg( QLocale().formattedDataSize( statistics.size ) )
+            .arg( statistics.count )
+            .arg( QLocale().formattedDataSize( BodyStore::get().budget() ) ) );
+    }
+
+    if( statistics.hits || statistics.misses )
+    {
+        item = new GridLayoutItem( this, gridLayout );
+        item->setKey( tr( "Text accesses:" ) );
+        item->setText( tr( "%1 hits, %2 misses, %3 evictions, %4 compactions" )
+            .arg( statistics.hits )
+            .arg( statistics.misses )
+            .arg( statistics.evictions )
+            .arg( statistics.compactions ) );
+    }
+
     gridLayout->setColumnStretch( 1, 1 );
 
     // detail
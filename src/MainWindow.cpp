@@ -23,6 +23,7 @@
 #include "BackupManagerDialog.h"
 #include "BackupManagerWidget.h"
 #include "BaseIconNames.h"
+#include "BodyStore.h"
 #include "ColorMenu.h"
 #include "ColumnSelectionMenu.h"
 #include "ColumnSortingMenu.h"
@@ -40,6 +41,7 @@
 #include "IconNames.h"
 #include "InformationDialog.h"
 #include "LineEditor.h"
+#include "LiveSync.h"
 #include "LogEntryInformationDialog.h"
 #include "LogEntryPrintOptionWidget.h"
 #include "LogEntryPrintSelectionDialog.h"
@@ -70,9 +72,12 @@
 #include "XmlOptions.h"
 
 
+#include <QDateTime>
 #include <QHeaderView>
+#include <QLocale>
 #include <QMenu>
 #include <QPrintDialog>
+#include <QScrollBar>
 #include <QSplitter>
 
 //_____________________________________________
@@ -89,6 +94,11 @@ MainWindow::MainWindow( QWidget *parent ):
     fileCheck_ = new FileCheck( this );
     connect( fileCheck_, &FileCheck::filesModified, this, &MainWindow::_filesModified );
 
+    // live synchronization
+    liveSync_ = new LiveSync( this );
+    connect( liveSync_, &LiveSync::entriesReceived, this, &MainWindow::_mergeLiveEntries );
+    connect( liveSync_, &LiveSync::connectionChanged, this, &MainWindow::_liveSyncConnectionChanged );
+
     // main widget
     auto main = new QWidget( this );
     setCentralWidget( main );
@@ -259,6 +269,7 @@ MainWindow::MainWindow( QWidget *parent ):
 
     connect( &entryModel_, &LogEntryModel::layoutChanged, entryList_, QOverload<>::of( &LogEntryList::resizeColumns ) );
     connect( &entryModel_, &LogEntryModel::dataChanged, this, &MainWindow::_entryDataChanged );
+    connect( entryList_->verticalScrollBar(), &QAbstractSlider::actionTriggered, this, &MainWindow::_entryListScrolled );
 
     /*
     add the deleteEntryAction to the list,
@@ -346,6 +357,17 @@ bool MainWindow::setLogbook( const File &file )
     // create new logbook
     logbook_.reset( new Logbook );
     logbook_->setUseCompression( XmlOptions::get().get<bool>( QStringLiteral("USE_COMPRESSION") ) );
+    logbook_->setParallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
+    logbook_->setUseSnapshot( XmlOptions::get().get<bool>( QStringLiteral("USE_SNAPSHOT") ) );
+    logbook_->setLazyLoading( XmlOptions::get().get<bool>( QStringLiteral("LAZY_LOADING") ) );
+    logbook_->setUseJournal( XmlOptions::get().get<bool>( QStringLiteral("USE_JOURNAL") ) );
+    logbook_->setSharding( Logbook::Sharding::fromOptions() );
+    logbook_->setCodec( FileFormat::codec( XmlOptions::get().raw( QStringLiteral("COMPRESSION_CODEC") ) ) );
+
+    // only read children with recent entries. Others are loaded on demand
+    const int loadedMonths( XmlOptions::get().get<int>( QStringLiteral("LOADED_MONTHS") ) );
+    if( loadedMonths > 0 )
+    { logbook_->setLoadedSince( TimeStamp( static_cast<time_t>( QDateTime::currentDateTime().addMonths( -loadedMonths ).toSecsSinceEpoch() ) ) ); }
 
     // if filename is empty, return
     if( file.isEmpty() )
@@ -461,12 +483,12 @@ bool MainWindow::setLogbook( const File &file )
         for( const auto& entry : entries )
         {
             // dissassociate
-            Base::Key::disassociate( entry, logbook_.get() );
+            logbook_->removeEntry( entry );
 
             // reassociate to latest child
-            auto child = logbook_->latestChild();
+            auto child = logbook_->childFor( entry );
             child->setModified(true);
-            Base::Key::associate( entry, child.get() );
+            child->addEntry( entry );
         }
 
         logbook_->setModified(true);
@@ -482,6 +504,9 @@ bool MainWindow::setLogbook( const File &file )
     // register logbook to fileCheck
     fileCheck_->registerLogbook( logbook_.get() );
 
+    // exchange entry changes with other running instance
+    liveSync_->setLogbook( logbook_.get() );
+
     emit ready();
 
     // check errors
@@ -537,6 +562,7 @@ void MainWindow::reset()
 {
 
     Debug::Throw( QStringLiteral("MainWindow::reset.\n") );
+    liveSync_->setLogbook( nullptr );
     if( logbook_ ) logbook_.reset();
 
     // clear list of entries
@@ -567,13 +593,20 @@ AskForSaveDialog::ReturnCode MainWindow::askForSave( bool enableCancel )
 
     Debug::Throw( QStringLiteral("MainWindow::askForSave.\n") );
 
+    // journaled changes are already saved. Write them to the logbook files with no confirmation
+    if( logbook_ && logbook_->hasJournal() )
+    {
+        saveUnchecked( true );
+        if( !logbookIsModified() ) return AskForSaveDialog::Yes;
+    }
+
     // create dialog
     AskForSaveDialog::ReturnCodes buttons( AskForSaveDialog::Yes | AskForSaveDialog::No );
     if( enableCancel ) buttons |= AskForSaveDialog::Cancel;
 
     // exec and check return code
     auto reply = AskForSaveDialog( this, tr("Logbook has been modified. Save ?"), buttons ).centerOnParent().exec();
-    if( reply == AskForSaveDialog::Yes ) saveUnchecked();
+    if( reply == AskForSaveDialog::Yes ) saveUnchecked( true );
     return AskForSaveDialog::ReturnCode(reply);
 
 }
@@ -799,7 +832,7 @@ Keyword MainWindow::currentKeyword() const
 }
 
 //_______________________________________________
-void MainWindow::saveUnchecked()
+bool MainWindow::saveUnchecked( bool compact )
 {
 
     Debug::Throw( QStringLiteral("MainWindow::saveUnchecked.\n") );
@@ -807,14 +840,13 @@ void MainWindow::saveUnchecked()
     if( !logbook_ )
     {
         InformationDialog( this, tr("No Logbook opened. <Save> canceled.") ).exec();
-        return;
+        return false;
     }
 
     // check logbook filename, go to Save As if no file is given and redirect is true
     if( logbook_->file().isEmpty() )
     {
-        _saveAs();
-        return;
+        return _saveAs();
     }
 
     // check logbook filename is writable
@@ -825,13 +857,13 @@ void MainWindow::saveUnchecked()
         // check file is not a directory
         if( fullname.isDirectory() ) {
             InformationDialog( this, tr("Selected file is a directory. <Save Logbook> canceled.") ).exec();
-            return;
+            return false;
         }
 
         // check file is writable
         if( !fullname.isWritable() ) {
             InformationDialog( this, tr("Selected file is not writable. <Save Logbook> canceled.") ).exec();
-            return;
+            return false;
         }
 
     } else {
@@ -839,25 +871,44 @@ void MainWindow::saveUnchecked()
         auto path( fullname.path() );
         if( !path.isDirectory() ) {
             InformationDialog( this, tr("Selected path is not vallid. <Save Logbook> canceled.") ).exec();
-            return;
+            return false;
         }
 
     }
 
+    // send changes to other running instance
+    liveSync_->update();
+
+    // append changes to journal if possible, in place of writing the logbook files
+    if( !compact && logbook_->writeJournal() )
+    {
+        updateWindowTitle();
+        statusbar_->label().setText( tr( "Changes appended to journal" ) );
+        statusbar_->showLabel();
+        return true;
+    }
+
     // write logbook to file, retrieve result
     Base::Singleton::get().application<Application>()->busy();
     _setEnabled( false );
 
     logbook_->truncateRecentEntriesList( maxRecentEntries_ );
 
-    logbook_->write();
+    const bool written( logbook_->write() );
     Base::Singleton::get().application<Application>()->idle();
     _setEnabled( true );
 
     updateWindowTitle();
 
-    // update StateFrame
-    statusbar_->label().clear();
+    // update StateFrame, with amount of data written and time spent
+    const auto& statistics( logbook_->writeStatistics() );
+    if( written )
+    {
+        statusbar_->label().setText( tr( "%n file(s) written (%1) in %2 ms, including %3 ms syncing to disk", nullptr, statistics.files )
+            .arg( QLocale().formattedDataSize( statistics.bytes ) )
+            .arg( statistics.writeTime + statistics.syncTime + statistics.renameTime )
+            .arg( statistics.syncTime + statistics.renameTime ) );
+    } else statusbar_->label().setText( tr( "Unable to write all logbook files" ) );
     statusbar_->showLabel();
 
     // add new file to openPreviousMenu
@@ -866,12 +917,12 @@ void MainWindow::saveUnchecked()
     // reset ignore_warning flag
     ignoreWarnings_ = false;
 
-    return;
+    return written;
 
 }
 
 //_______________________________________________
-void MainWindow::save()
+bool MainWindow::save()
 {
 
     Debug::Throw( QStringLiteral("MainWindow::save.\n") );
@@ -880,12 +931,12 @@ void MainWindow::save()
     if( !logbook_ )
     {
         InformationDialog( this, tr("No Logbook opened. <Save> canceled.") ).exec();
-        return;
+        return false;
     }
 
-    if( checkModifiedEntries() == AskForSaveDialog::Cancel ) return;
+    if( checkModifiedEntries() == AskForSaveDialog::Cancel ) return false;
 
-    saveUnchecked();
+    return saveUnchecked();
 
 }
 
@@ -911,6 +962,9 @@ void MainWindow::selectEntries( const QString &selection, SearchWidget::SearchMo
         return;
     }
 
+    // search all entries
+    _loadAllEntries();
+
     // number of found items
     int found( 0 );
     int total( 0 );
@@ -1031,7 +1085,7 @@ void MainWindow::closeEvent( QCloseEvent *event )
         event->ignore();
         return;
 
-    } else if( reply == AskForSaveDialog::Yes ) saveUnchecked();
+    } else if( reply == AskForSaveDialog::Yes ) saveUnchecked( true );
     else if( logbookIsModified() && askForSave() == AskForSaveDialog::Cancel ) return;
 
     // quit application
@@ -1188,6 +1242,10 @@ void MainWindow::_installActions()
     reorganizeAction_->setToolTip( tr("Reoganize logbook entries in files") );
     connect( reorganizeAction_, &QAction::triggered, this, &MainWindow::_reorganize );
 
+    loadEntriesAction_ = new QAction( tr("Load All Entries"), this );
+    loadEntriesAction_->setToolTip( tr("Load logbook entries older than the loaded range") );
+    connect( loadEntriesAction_, &QAction::triggered, this, &MainWindow::_loadAllEntries );
+
     saveAction_ = new QAction( IconEngine::get( IconNames::Save ), tr("Save"), this );
     saveAction_->setToolTip( tr("Save all edited entries") );
     connect( saveAction_, &QAction::triggered, this, &MainWindow::save );
@@ -1294,6 +1352,14 @@ void MainWindow::_resetKeywordList()
             }
         }
     }
+
+    // keywords of entries not loaded yet
+    for( auto keyword:logbook_->unloadedKeywords() )
+    {
+        for( ; keyword != root; keyword = keyword.parent() )
+        { newKeywords.insert( keyword ); }
+    }
+
     keywordModel_.set( Base::makeT<KeywordModel::List>(newKeywords) );
 }
 
@@ -1392,7 +1458,8 @@ void MainWindow::_autoSave()
             window->saveAction().trigger();
         }
 
-        save();
+        // also write journaled changes to the logbook files
+        saveUnchecked( true );
 
     } else {
 
@@ -1654,16 +1721,17 @@ bool MainWindow::_saveAs( File defaultFile, bool registerLogbook )
     // change logbook filename and save
     logbook_->setFile( fullname );
     logbook_->setModifiedRecursive( true );
-    save();
+    const bool saved( save() );
 
     // update current file in menu
     menuBar_->recentFilesMenu().setCurrentFile( fullname );
 
     /*
     force logbook state to unmodified since
-    some children state may not have been reset properly
+    some children state may not have been reset properly.
+    This is skipped when the logbook could not be written
     */
-    logbook_->setModifiedRecursive( false );
+    if( saved ) logbook_->setModifiedRecursive( false );
 
     // add new file to openPreviousMenu
     if( !logbook_->file().isEmpty() )
@@ -1679,7 +1747,7 @@ bool MainWindow::_saveAs( File defaultFile, bool registerLogbook )
     // reset ignore_warning flag
     ignoreWarnings_ = false;
 
-    return true;
+    return saved;
 }
 
 
@@ -2077,6 +2145,9 @@ void MainWindow::_synchronize()
     Logbook remoteLogbook;
     connect( &remoteLogbook, &Logbook::messageAvailable, this, &MainWindow::messageAvailable );
     remoteLogbook.setFile( remoteFile );
+    remoteLogbook.setParallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
+    remoteLogbook.setCodec( FileFormat::codec( XmlOptions::get().raw( QStringLiteral("COMPRESSION_CODEC") ) ) );
+    remoteLogbook.setManifestOnly( true );
     remoteLogbook.read();
 
     // check if logbook is valid
@@ -2144,7 +2215,17 @@ void MainWindow::_synchronize()
 
     // idle
     Base::Singleton::get().application<Application>()->idle();
-    statusbar_->label().clear();
+
+    // show summary
+    const auto& local( logbook_->synchronizeStatistics() );
+    const auto& remote( remoteLogbook.synchronizeStatistics() );
+    statusbar_->label().setText( tr( "Local: %1 added, %2 replaced, %3 merged, %4 skipped. Remote: %5 added, %6 replaced, %7 merged, %8 skipped" )
+        .arg( local.added ).arg( local.replaced ).arg( local.merged ).arg( local.skipped )
+        .arg( remote.added ).arg( remote.replaced ).arg( remote.merged ).arg( remote.skipped ) );
+    statusbar_->showLabel();
+
+    // conflicts are all found when updating local from remote
+    _reportConflicts( local.conflicts );
 
     return;
 
@@ -2305,6 +2386,7 @@ void MainWindow::_mergeBackup( const Backup &backup )
     Logbook backupLogbook;
     connect( &backupLogbook, &Logbook::messageAvailable, this, &MainWindow::messageAvailable );
     backupLogbook.setFile( backup.file() );
+    backupLogbook.setManifestOnly( true );
     backupLogbook.read();
 
     // check if logbook is valid
@@ -2366,10 +2448,88 @@ void MainWindow::_mergeBackup( const Backup &backup )
     Base::Singleton::get().application<Application>()->idle();
     statusbar_->label().clear();
 
+    _reportConflicts( logbook_->synchronizeStatistics().conflicts );
+
     return;
 
 }
 
+//_______________________________________________
+void MainWindow::_mergeLiveEntries( Logbook& remoteLogbook )
+{
+    Debug::Throw( QStringLiteral("MainWindow::_mergeLiveEntries.\n") );
+    if( !logbook_ || logbook_->isReadOnly() ) return;
+
+    // synchronize local with received entries
+    auto duplicates( logbook_->synchronize( remoteLogbook ) );
+    for( auto&& iter = duplicates.begin(); iter != duplicates.end(); ++iter )
+    {
+
+        // display the new entry in all matching edit frames
+        for( const auto& window:Base::KeySet<EditionWindow>( iter.key() ) )
+        { window->displayEntry( iter.value() ); }
+
+        delete iter.key();
+
+    }
+
+    // update lists, preserving selection
+    _updateLoadedEntries();
+    resetAttachmentWindow();
+    updateWindowTitle();
+
+    const auto& statistics( logbook_->synchronizeStatistics() );
+    statusbar_->label().setText( tr( "Received entries: %1 added, %2 replaced, %3 merged, %4 skipped" )
+        .arg( statistics.added ).arg( statistics.replaced ).arg( statistics.merged ).arg( statistics.skipped ) );
+    statusbar_->showLabel();
+
+    _reportConflicts( statistics.conflicts );
+
+}
+
+//_______________________________________________
+void MainWindow::_liveSyncConnectionChanged( bool connected )
+{
+    Debug::Throw( QStringLiteral("MainWindow::_liveSyncConnectionChanged.\n") );
+    statusbar_->label().setText( connected ?
+        tr( "Connected to other running instance" ):
+        tr( "Disconnected from other running instance" ) );
+    statusbar_->showLabel();
+}
+
+//_______________________________________________
+void MainWindow::_reportConflicts( const Logbook::Conflict::List& conflicts )
+{
+    Debug::Throw( QStringLiteral("MainWindow::_reportConflicts.\n") );
+    if( conflicts.empty() ) return;
+
+    QString buffer( conflicts.size() > 1 ?
+        tr( "%1 entries were modified on both sides since they were last synchronized:\n" ).arg( conflicts.size() ):
+        tr( "One entry was modified on both sides since it was last synchronized:\n" ) );
+
+    for( const auto& conflict:conflicts )
+    {
+
+        QStringList groups;
+        if( conflict.groups & LogEntry::HeaderGroup ) groups.append( tr( "header" ) );
+        if( conflict.groups & LogEntry::TextGroup ) groups.append( tr( "text" ) );
+        if( conflict.groups & LogEntry::FormatsGroup ) groups.append( tr( "formatting" ) );
+        if( conflict.groups & LogEntry::AttachmentsGroup ) groups.append( tr( "attachments" ) );
+
+        buffer += QStringLiteral( "\n" );
+        buffer += tr( "%1 (created %2): %3 - %4 version kept%5" )
+            .arg( conflict.title.isEmpty() ? tr( "untitled" ):conflict.title )
+            .arg( conflict.creation.toString() )
+            .arg( groups.join( QStringLiteral( ", " ) ) )
+            .arg( conflict.remoteKept ? tr( "remote" ):tr( "local" ) )
+            .arg( conflict.hasBase ? QString():tr( " (no common version)" ) );
+
+    }
+
+    InformationDialog( this, buffer ).exec();
+
+}
+
 //_______________________________________________
 void MainWindow::_reorganize()
 {
@@ -2382,12 +2542,13 @@ void MainWindow::_reorganize()
     }
 
     // retrieve all entries
+    logbook_->loadChildren();
     auto entries( logbook_->entries() );
 
     // clear all logbook-to-entry associations
-    logbook_->removeAssociatedKeys<LogEntry>();
+    logbook_->clearEntries();
     for( const auto& logbook:logbook_->children() )
-    { logbook->removeAssociatedKeys<LogEntry>(); }
+    { logbook->clearEntries(); }
 
     // put entry set into a list and sort by creation time.
     // First entry must the oldest
@@ -2397,24 +2558,24 @@ void MainWindow::_reorganize()
     // put entries in logbook
     for( const auto& entry:entryList )
     {
-        auto logbook( logbook_->latestChild() );
+        auto logbook( logbook_->childFor( entry ) );
         if( entry->isAssociated( logbook.get() ) )
         {
 
             // redo the association to the logbook, but do not mark logbook as modified
-            Base::Key::associate( entry, logbook.get() );
+            logbook->addEntry( entry );
 
         } else {
 
-            // mark original logbooks as modified
+            // mark original logbooks as modified, and clear association
             for( const auto& logbook:Base::KeySet<Logbook>(entry) )
-            { logbook->setModified( true ); }
-
-            // clear association to old logbook
-            entry->clearAssociations<Logbook>();
+            {
+                logbook->setModified( true );
+                logbook->removeEntry( entry );
+            }
 
             // associate to this logbook
-            Base::Key::associate( entry, logbook.get() );
+            logbook->addEntry( entry );
 
             // mark logbook as modified
             logbook->setModified( true );
@@ -2436,11 +2597,77 @@ void MainWindow::_reorganize()
 
 }
 
+//_______________________________________________
+void MainWindow::_loadAllEntries()
+{
+    Debug::Throw( QStringLiteral("MainWindow::_loadAllEntries.\n") );
+    if( logbook_ && logbook_->loadChildren() ) _updateLoadedEntries();
+}
+
+//_______________________________________________
+void MainWindow::_entryListScrolled()
+{
+
+    if( !logbook_ ) return;
+
+    // load previous child when either end of the list is reached
+    const auto scrollBar( entryList_->verticalScrollBar() );
+    const auto position( scrollBar->sliderPosition() );
+    if( position != scrollBar->minimum() && position != scrollBar->maximum() ) return;
+
+    if( logbook_->loadPreviousChild() ) _updateLoadedEntries();
+
+}
+
+//_______________________________________________
+void MainWindow::_updateLoadedEntries()
+{
+
+    Debug::Throw( QStringLiteral("MainWindow::_updateLoadedEntries.\n") );
+
+    // keep track of the current selected entry
+    auto currentIndex( entryList_->selectionModel()->currentIndex() );
+    LogEntry *selectedEntry( currentIndex.isValid() ? entryModel_.get( currentIndex ):nullptr );
+
+    // update keyword selection of loaded entries
+    _updateKeywordSelection( currentKeyword() );
+
+    // reinitialize lists
+    _resetKeywordList();
+    _resetLogEntryList();
+
+    if( selectedEntry && selectedEntry->isSelected() ) selectEntry( selectedEntry );
+
+}
+
+//_______________________________________________
+void MainWindow::_updateKeywordSelection( const Keyword& keyword )
+{
+
+    Debug::Throw( QStringLiteral("MainWindow::_updateKeywordSelection.\n") );
+
+    // reset previously selected entries
+    for( const auto& entry:Base::KeySet<LogEntry>( &keywordSelection_ ) )
+    { entry->setKeywordSelected( false ); }
+    keywordSelection_.clearAssociations();
+
+    // select entries matching keyword
+    for( const auto& entry:logbook_->keywordIndex().entries( keyword ) )
+    {
+        entry->setKeywordSelected( true );
+        Base::Key::associate( &keywordSelection_, entry );
+    }
+
+}
+
 //_______________________________________________
 void MainWindow::_showDuplicatedEntries()
 {
     Debug::Throw( QStringLiteral("MainWindow::_showDuplicatedEntries.\n") );
 
+    // check all entries
+    _loadAllEntries();
+
     // keep track of the last visible entry
     LogEntry *lastVisibleEntry( nullptr );
 
@@ -2451,8 +2678,12 @@ void MainWindow::_showDuplicatedEntries()
     // keep track of found entries
     int found( 0 );
 
-    // retrieve all logbook entries
+    // retrieve all logbook entries, and count them by creation time, in a single pass
     Base::KeySet<LogEntry> entries( logbook_->entries() );
+    QHash<qint64, int> creationCounts;
+    for( const auto& entry:entries )
+    { ++creationCounts[entry->creation().unixTime()]; }
+
     Base::KeySet<LogEntry> turnedOffEntries;
     for( const auto& entry:entries )
     {
@@ -2461,7 +2692,7 @@ void MainWindow::_showDuplicatedEntries()
         if( !entry->isSelected() ) continue;
 
         // check duplicated entries
-        int duplicates( std::count_if( entries.begin(), entries.end(), LogEntry::SameCreationFTor( entry->creation() ) ) );
+        int duplicates( creationCounts.value( entry->creation().unixTime() ) );
         if( duplicates < 2 ) {
 
             entry->setFindSelected( false );
@@ -2951,24 +3182,9 @@ void MainWindow::_deleteKeyword()
     { if( index.isValid() ) keywords.append( keywordModel_.get( index ) ); }
 
     // retrieve associated entries
-    Base::KeySet<LogEntry> entries( logbook_->entries() );
     Base::KeySet<LogEntry> associatedEntries;
     for( const auto& keyword:keywords )
-    {
-        for( const auto& entry:entries )
-        {
-            for( const auto& entryKeyword:entry->keywords() )
-            {
-                if( entryKeyword.inherits( keyword ) )
-                {
-                    associatedEntries.insert( entry );
-                    break;
-                }
-            }
-
-        }
-
-    }
+    { associatedEntries.unite( logbook_->keywordIndex().inheritingEntries( keyword ) ); }
 
     // create dialog
     DeleteKeywordDialog dialog( this, keywords, !associatedEntries.empty() );
@@ -3092,41 +3308,41 @@ void MainWindow::_renameKeyword( const Keyword &keyword, const Keyword &newKeywo
     // check keywords are different
     if( keyword == newKeyword ) return;
 
-    // get entries matching the oldKeyword, change the keyword
-    for( const auto& entry:logbook_->entries() )
-    {
+    /*
+    get entries matching the old keyword or any of its descendants.
+    They are all retrieved before being modified, since new keywords might also inherit from the old one
+    */
+    const auto& index( logbook_->keywordIndex() );
+    QList<QPair<Keyword, Base::KeySet<LogEntry>>> matches;
+    for( const auto& entryKeyword:index.inheritingKeywords( keyword ) )
+    { matches.append( qMakePair( entryKeyword, index.entries( entryKeyword ) ) ); }
 
-        /*
-        if keyword to modify is a leading subset of current entry keyword,
-        update entry with new keyword
-        */
-        bool modified = false;
-        const auto keywords( entry->keywords() );
-        for( auto entryKeyword:keywords )
+    // change the keyword
+    Base::KeySet<LogEntry> modifiedEntries;
+    for( const auto& match:matches )
+    {
+        const Keyword entryKeyword( QString( match.first.get() ).replace( keyword.get(), newKeyword.get() ) );
+        for( const auto& entry:match.second )
         {
-            if( entryKeyword.inherits( keyword ) )
-            {
-                entry->replaceKeyword( entryKeyword, Keyword( QString( entryKeyword.get() ).replace( keyword.get(), newKeyword.get() ) ) );
-                modified = true;
-            }
+            entry->replaceKeyword( match.first, entryKeyword );
+            modifiedEntries.insert( entry );
         }
+    }
 
-        if( modified )
-        {
-
-            /* this is a kludge: add 1 second to the entry modification timeStamp to avoid loosing the
-            keyword change when synchronizing logbooks, without having all entries modification time
-            set to now() */
-            entry->setModification( TimeStamp( entry->modification().unixTime()+1 ) );
+    for( const auto& entry:modifiedEntries )
+    {
 
-            // update frames
-            _updateEntryFrames( entry, KeywordMask );
+        /* this is a kludge: add 1 second to the entry modification timeStamp to avoid loosing the
+        keyword change when synchronizing logbooks, without having all entries modification time
+        set to now() */
+        entry->setModification( TimeStamp( entry->modification().unixTime()+1 ) );
 
-            // set associated logbooks as modified
-            for( const auto& logbook:Base::KeySet<Logbook>( entry ) )
-            { logbook->setModified( true ); }
+        // update frames
+        _updateEntryFrames( entry, KeywordMask );
 
-        }
+        // set associated logbooks as modified
+        for( const auto& logbook:Base::KeySet<Logbook>( entry ) )
+        { logbook->setModified( true ); }
 
     }
 
@@ -3294,7 +3510,8 @@ void MainWindow::_copyEntryKeyword( const Keyword &newKeyword )
         //* copy entry to new one
         auto newEntry = entry->copy();
 
-        // assign creation and modification to now
+        // assign new identifier, creation and modification to now
+        newEntry->setId( LogEntry::generateId() );
         newEntry->setCreation( TimeStamp::now() );
         newEntry->setModification( TimeStamp::now() );
 
@@ -3303,9 +3520,9 @@ void MainWindow::_copyEntryKeyword( const Keyword &newKeyword )
         newEntry->addKeyword( newKeyword );
 
         //* associate to logbook
-        auto logbook( logbook_->latestChild() );
+        auto logbook( logbook_->childFor( newEntry ) );
         logbook->setModified( true );
-        Base::Key::associate( newEntry, logbook.get() );
+        logbook->addEntry( newEntry );
 
         // keep track of modified entries
         entries.insert( newEntry );
@@ -3430,10 +3647,11 @@ void MainWindow::_keywordSelectionChanged( const QModelIndex& index )
     auto currentIndex( entryList_->selectionModel()->currentIndex() );
     LogEntry *selectedEntry( currentIndex.isValid() ? entryModel_.get( currentIndex ):nullptr );
 
-    // retrieve all logbook entries
-    Base::KeySet<LogEntry> turnedOffEntries;
-    for( const auto& entry:logbook_->entries() )
-    { entry->setKeywordSelected( entry->keywords().contains( keyword ) ); }
+    // load entries matching keyword, if not already
+    logbook_->loadChildren( keyword );
+
+    // update keyword selection
+    _updateKeywordSelection( keyword );
 
     // reinitialize logEntry list
     _resetLogEntryList();
@@ -3704,8 +3922,24 @@ void MainWindow::_updateConfiguration()
 
     resize( sizeHint() );
 
+    // live synchronization
+    if( !XmlOptions::get().get<bool>( QStringLiteral("LIVE_SYNC") ) ) liveSync_->stop();
+    else if( !liveSync_->isStarted() ) liveSync_->start( XmlOptions::get().raw( QStringLiteral("LIVE_SYNC_CHANNEL") ) );
+
     // compression
-    if( logbook_ ) logbook_->setUseCompression( XmlOptions::get().get<bool>( QStringLiteral("USE_COMPRESSION") ) );
+    if( logbook_ )
+    {
+        logbook_->setUseCompression( XmlOptions::get().get<bool>( QStringLiteral("USE_COMPRESSION") ) );
+        logbook_->setParallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
+        logbook_->setUseSnapshot( XmlOptions::get().get<bool>( QStringLiteral("USE_SNAPSHOT") ) );
+        logbook_->setLazyLoading( XmlOptions::get().get<bool>( QStringLiteral("LAZY_LOADING") ) );
+        logbook_->setUseJournal( XmlOptions::get().get<bool>( QStringLiteral("USE_JOURNAL") ) );
+        logbook_->setSharding( Logbook::Sharding::fromOptions() );
+        logbook_->setCodec( FileFormat::codec( XmlOptions::get().raw( QStringLiteral("COMPRESSION_CODEC") ) ) );
+    }
+
+    // memory budget for entries text
+    BodyStore::get().setBudget( qint64( XmlOptions::get().get<int>( QStringLiteral("TEXT_MEMORY_BUDGET") ) ) << 20 );
 
     // autoSave
     autoSaveDelay_ = 1000*XmlOptions::get().get<int>( QStringLiteral("AUTO_SAVE_ITV") );
@@ -3746,6 +3980,7 @@ LogEntryModel::List MainWindow::_entries( LogEntryPrintSelectionWidget::Mode mod
     {
         default:
         case LogEntryPrintSelectionWidget::Mode::AllEntries:
+        logbook_->loadChildren();
         return Base::makeT<LogEntryModel::List>( logbook_->entries() );
 
         case LogEntryPrintSelectionWidget::Mode::VisibleEntries:
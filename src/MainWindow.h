@@ -47,6 +47,7 @@ class ColorMenu;
 class ToolBar;
 class EditionWindow;
 class FileCheck;
+class LiveSync;
 class LogbookPrintHelper;
 class MenuBar;
 class ProgressStatusBar;
@@ -171,16 +172,21 @@ class MainWindow: public BaseMainWindow, private Base::Counter<MainWindow>, publ
     void open( FileRecord );
 
     //* save current logbook
-    /** pending entry modifications are ignored */
-    void saveUnchecked();
+    /**
+    pending entry modifications are ignored.
+    Changes are appended to the journal when enabled, unless compact is true, in which case the logbook files are written.
+    Returns false if the logbook could not be saved
+    */
+    bool saveUnchecked( bool compact = false );
 
     //* save current logbook
     /**
     if there are pending enry modifications, they are first saved to the logbook,
     then the logbook is saved.
-    if argument is false, all modified entries will be saved without asking
+    if argument is false, all modified entries will be saved without asking.
+    Returns false if the logbook could not be saved
     */
-    void save();
+    bool save();
 
     //* select entry
     void selectEntry( LogEntry* );
@@ -263,6 +269,10 @@ class MainWindow: public BaseMainWindow, private Base::Counter<MainWindow>, publ
     QAction& reorganizeAction() const
     { return *reorganizeAction_; }
 
+    //* load entries older than loaded range
+    QAction& loadEntriesAction() const
+    { return *loadEntriesAction_; }
+
     //* save logbook
     QAction& saveAction() const
     { return *saveAction_; }
@@ -405,11 +415,29 @@ class MainWindow: public BaseMainWindow, private Base::Counter<MainWindow>, publ
     //* merge backup
     void _mergeBackup( const Backup &);
 
+    //* merge entries received from other running instance
+    void _mergeLiveEntries( Logbook& );
+
+    //* connection to other running instance changed
+    void _liveSyncConnectionChanged( bool );
+
     //* reorganize logbook to entries associations
     void _reorganize();
 
+    //* load entries older than loaded range, and update lists
+    void _loadAllEntries();
+
+    //* load previous logbook child when reaching either end of entry list
+    void _entryListScrolled();
+
+    //* update lists after entries have been loaded, preserving selection
+    void _updateLoadedEntries();
+
+    //* select entries matching keyword, using the keyword index
+    void _updateKeywordSelection( const Keyword& );
+
     /** \brief
-    show all entries which have equal creation time
+    show all entries which have equal identifier
     is needed to remove duplicate entries in case of
     wrong logbook merging. This is a Debugging tool
     */
@@ -531,6 +559,9 @@ class MainWindow: public BaseMainWindow, private Base::Counter<MainWindow>, publ
     //* configuration
     void _updateConfiguration();
 
+    //* show synchronization conflicts, if any
+    void _reportConflicts( const Logbook::Conflict::List& );
+
     //* clear list and reinitialize from logbook entries
     void _resetKeywordList();
 
@@ -604,6 +635,12 @@ class MainWindow: public BaseMainWindow, private Base::Counter<MainWindow>, publ
     //* file check
     FileCheck* fileCheck_ = nullptr;
 
+    //* entry changes exchange with other running instance
+    LiveSync* liveSync_ = nullptr;
+
+    //* associated to entries selected by the keyword list, for their selection to be reset when keyword changes
+    Base::Key keywordSelection_;
+
     //* Keyword list
     KeywordList *keywordList_ = nullptr;
 
@@ -717,6 +754,9 @@ class MainWindow: public BaseMainWindow, private Base::Counter<MainWindow>, publ
     //* reorganize logbook
     QAction* reorganizeAction_ = nullptr;
 
+    //* load entries older than loaded range
+    QAction* loadEntriesAction_ = nullptr;
+
     //* save logbook
     QAction* saveAction_ = nullptr;
 
@@ -67,6 +67,7 @@ MenuBar::MenuBar( QWidget* parent, MainWindow* mainWindow ):
 
     menu->addAction( &mainWindow->synchronizeAction() );
     menu->addAction( &mainWindow->reorganizeAction() );
+    menu->addAction( &mainWindow->loadEntriesAction() );
 
     menu->addSeparator();
     if( editionWindow ) menu->addAction( &editionWindow->saveAction() );
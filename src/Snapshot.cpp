@@ -0,0 +1,149 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Snapshot.h"
+#include "Debug.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace
+{
+
+    namespace Local
+    {
+
+        //* magic string
+        static const QByteArray Magic( "ELGS" );
+
+        //________________________________________________________
+        //* true if signatures match. Hash is ignored if empty in reference
+        bool matches( const Snapshot::Signature& reference, const Snapshot::Signature& signature )
+        {
+            return
+                reference.size == signature.size &&
+                reference.lastModified == signature.lastModified &&
+                ( reference.hash.isEmpty() || reference.hash == signature.hash );
+        }
+
+    }
+
+}
+
+//________________________________________________________
+Snapshot::Signature Snapshot::signature( const File& file, const QByteArray& content )
+{
+    Signature out;
+    out.size = content.size();
+    out.lastModified = QFileInfo( file ).lastModified().toMSecsSinceEpoch();
+    out.hash = QCryptographicHash::hash( content, QCryptographicHash::Md5 );
+    return out;
+}
+
+//________________________________________________________
+Snapshot::Signature Snapshot::signature( const File& file )
+{
+    const QFileInfo info( file );
+    Signature out;
+    out.size = info.size();
+    out.lastModified = info.lastModified().toMSecsSinceEpoch();
+    return out;
+}
+
+//________________________________________________________
+File Snapshot::file( const File& file )
+{ return File( QStringLiteral( ".%1.snapshot" ).arg( file.localName().get() ) ).addPath( file.path() ); }
+
+//________________________________________________________
+QByteArray Snapshot::read( const File& source, const Signature& signature )
+{
+
+    QFile in( file( source ) );
+    if( !in.open( QIODevice::ReadOnly ) ) return QByteArray();
+
+    // magic
+    if( in.read( Local::Magic.size() ) != Local::Magic ) return QByteArray();
+
+    // header
+    QDataStream stream( &in );
+    setup( stream );
+
+    quint32 version( 0 );
+    Signature reference;
+    stream >> version >> reference.size >> reference.lastModified >> reference.hash;
+    if( stream.status() != QDataStream::Ok || version != Version || !Local::matches( reference, signature ) )
+    {
+        Debug::Throw() << "Snapshot::read - snapshot is obsolete for " << source << Qt::endl;
+        return QByteArray();
+    }
+
+    // payload
+    return in.readAll();
+
+}
+
+//________________________________________________________
+bool Snapshot::write( const File& source, const QByteArray& payload, const Signature& expected )
+{
+
+    // read source, and check it has not been modified since the payload was generated
+    QFile in( source );
+    if( !in.open( QIODevice::ReadOnly ) ) return false;
+    const auto signature( Snapshot::signature( source, in.readAll() ) );
+    in.close();
+
+    if( !Local::matches( expected, signature ) )
+    {
+        Debug::Throw() << "Snapshot::write - source has changed, snapshot discarded for " << source << Qt::endl;
+        return false;
+    }
+
+    // write to temporary file, then rename, so that an interrupted write never leaves a truncated snapshot
+    QSaveFile out( file( source ) );
+    if( !out.open( QIODevice::WriteOnly ) ) return false;
+
+    out.write( Local::Magic );
+
+    QDataStream stream( &out );
+    setup( stream );
+    stream << quint32( Version ) << signature.size << signature.lastModified << signature.hash;
+    stream.writeRawData( payload.constData(), payload.size() );
+
+    return stream.status() == QDataStream::Ok && out.commit();
+
+}
+
+//________________________________________________________
+void Snapshot::setup( QDataStream& stream )
+{ stream.setVersion( QDataStream::Qt_5_6 ); }
+
+//________________________________________________________
+void Snapshot::writeTimeStamp( QDataStream& stream, const TimeStamp& timeStamp )
+{ stream << qint64( timeStamp.isValid() ? timeStamp.unixTime():-1 ); }
+
+//________________________________________________________
+TimeStamp Snapshot::readTimeStamp( QDataStream& stream )
+{
+    qint64 value( -1 );
+    stream >> value;
+    return value >= 0 ? TimeStamp( static_cast<time_t>( value ) ):TimeStamp();
+}
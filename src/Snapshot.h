@@ -0,0 +1,88 @@
+#ifndef Snapshot_h
+#define Snapshot_h
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "File.h"
+#include "TimeStamp.h"
+
+#include <QByteArray>
+#include <QDataStream>
+
+/**
+binary snapshot of a logbook file.
+Snapshots are stored as a hidden sidecar file, next to the logbook file.
+They start with the signature of the logbook file they have been generated from,
+namely its size, its last modification time and the hash of its raw content,
+followed by a binary dump of the logbook content.
+The xml file remains the reference: a snapshot that does not match the signature is ignored.
+*/
+namespace Snapshot
+{
+
+    //* payload version. Must be incremented whenever the binary dump of any object changes
+    static const int Version = 6;
+
+    //* logbook file signature
+    class Signature
+    {
+
+        public:
+
+        //* file size
+        qint64 size = -1;
+
+        //* last modification time (ms since epoch)
+        qint64 lastModified = -1;
+
+        //* raw content hash. It is not checked when empty
+        QByteArray hash;
+
+    };
+
+    //* signature of logbook file, from its raw content
+    Signature signature( const File&, const QByteArray& );
+
+    //* signature of logbook file, from its size and modification time only
+    Signature signature( const File& );
+
+    //* snapshot file associated to a logbook file
+    File file( const File& );
+
+    //* snapshot payload associated to a logbook file, if it matches signature. Returns an empty array otherwise
+    /** this is safe to be called from worker threads */
+    QByteArray read( const File&, const Signature& );
+
+    //* write snapshot payload associated to a logbook file, provided that it still matches signature
+    /** this is safe to be called from worker threads */
+    bool write( const File&, const QByteArray&, const Signature& );
+
+    //* prepare data stream for payload reading or writing
+    void setup( QDataStream& );
+
+    //* write time stamp to data stream
+    void writeTimeStamp( QDataStream&, const TimeStamp& );
+
+    //* read time stamp from data stream
+    TimeStamp readTimeStamp( QDataStream& );
+
+}
+
+#endif
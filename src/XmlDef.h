@@ -46,10 +46,16 @@ namespace Xml
     static const QString BackupMask( QStringLiteral("Logbook_backup") );
     static const QString Title( QStringLiteral("title") );
     static const QString Author( QStringLiteral("author") );
+    static const QString Id( QStringLiteral("id") );
     static const QString SortMethod( QStringLiteral("sort_method") );
     static const QString SortOrder( QStringLiteral("sort_order") );
     static const QString Entries( QStringLiteral("entries") );
     static const QString Children( QStringLiteral("children") );
+    static const QString FirstCreation( QStringLiteral("first_creation") );
+    static const QString LastCreation( QStringLiteral("last_creation") );
+    static const QString LastModification( QStringLiteral("last_modification") );
+    static const QString Hash( QStringLiteral("hash") );
+    static const QString BaseHash( QStringLiteral("base_hash") );
     static const QString Text( QStringLiteral("Text") );
     static const QString Keyword( QStringLiteral("key") );
     static const QString KeywordValue( QStringLiteral("value") );
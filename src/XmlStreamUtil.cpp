@@ -0,0 +1,81 @@
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "XmlStreamUtil.h"
+
+namespace XmlStreamUtil
+{
+
+    //______________________________________________________________________
+    QDomElement readElement( QXmlStreamReader& reader, QDomDocument& document )
+    {
+
+        auto out( document.createElement( reader.name().toString() ) );
+        for( const auto& attribute:reader.attributes() )
+        { out.setAttribute( attribute.name().toString(), attribute.value().toString() ); }
+
+        while( !reader.atEnd() )
+        {
+            switch( reader.readNext() )
+            {
+                case QXmlStreamReader::StartElement:
+                out.appendChild( readElement( reader, document ) );
+                break;
+
+                case QXmlStreamReader::Characters:
+                // whitespace only nodes are dropped, consistently with QDomDocument::setContent
+                if( !reader.isWhitespace() ) out.appendChild( document.createTextNode( reader.text().toString() ) );
+                break;
+
+                case QXmlStreamReader::EndElement:
+                return out;
+
+                default: break;
+            }
+        }
+
+        return out;
+
+    }
+
+    //______________________________________________________________________
+    void writeElement( QXmlStreamWriter& writer, const QDomElement& element )
+    {
+
+        writer.writeStartElement( element.tagName() );
+
+        const auto attributes( element.attributes() );
+        for( int i=0; i<attributes.count(); i++ )
+        {
+            const auto attribute( attributes.item( i ).toAttr() );
+            if( !attribute.isNull() ) writer.writeAttribute( attribute.name(), attribute.value() );
+        }
+
+        for( auto&& node = element.firstChild(); !node.isNull(); node = node.nextSibling() )
+        {
+            if( node.isElement() ) writeElement( writer, node.toElement() );
+            else if( node.isText() ) writer.writeCharacters( node.toText().data() );
+        }
+
+        writer.writeEndElement();
+
+    }
+
+}
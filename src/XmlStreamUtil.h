@@ -0,0 +1,47 @@
+#ifndef XmlStreamUtil_h
+#define XmlStreamUtil_h
+
+
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+//* helpers to mix streamed xml parsing with existing DOM based objects
+namespace XmlStreamUtil
+{
+
+    //* read current element and its descendants into a detached dom element
+    /**
+    the reader must be positioned on the element StartElement token.
+    On return it is positioned on the matching EndElement token.
+    This is only meant for small leaf elements (time stamps, colors, text formats)
+    whose parsing is implemented on top of the DOM.
+    */
+    QDomElement readElement( QXmlStreamReader&, QDomDocument& );
+
+    //* write dom element and its descendants to xml stream
+    void writeElement( QXmlStreamWriter&, const QDomElement& );
+
+}
+
+#endif
@@ -47,12 +47,13 @@ int main (int argc, char *argv[])
     // TODO use command-line arguments
     if( argc < 2 )
     {
-        Debug::Throw(0) << "usage: compress-logbook <input file>" << Qt::endl;
+        Debug::Throw(0) << "usage: compress-logbook <input file> [zstd|lz4|zlib]" << Qt::endl;
         return 0;
     }
 
-    // load argument
+    // load arguments
     File input( argv[1] );
+    QString codecName( argc > 2 ? QString( argv[2] ):QString() );
 
     // load options
     QString user( Util::user( ) );
@@ -79,13 +80,13 @@ int main (int argc, char *argv[])
     QCoreApplication application( argc, argv );
 
     // install error handler
-    ErrorHandler::get().disableMessage( QStringLiteral("qUncompress: Z_DATA_ERROR: Input data is corrupted file") );
     ErrorHandler::initialize();
 
     // try open input logbook
     Debug::Throw(0) << "compress-logbook - reading from: " << input << Qt::endl;
     Logbook logbook;
     logbook.setFile( input.expanded() );
+    logbook.setParallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
     if( !logbook.read() )
     {
         Debug::Throw(0) << "compress-logbook - error reading logbook" << Qt::endl;
@@ -99,6 +100,7 @@ int main (int argc, char *argv[])
     // perform copy
     Debug::Throw(0) << "compress-logbook - compressing" << Qt::endl;
     logbook.setUseCompression( true );
+    logbook.setCodec( codecName.isEmpty() ? FileFormat::codec( XmlOptions::get().raw( QStringLiteral("COMPRESSION_CODEC") ) ):FileFormat::codec( codecName ) );
     logbook.setModifiedRecursive( true );
 
     // copy logbook to ouput
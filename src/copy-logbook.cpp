@@ -83,7 +83,6 @@ int main (int argc, char *argv[])
     QCoreApplication application( argc, argv );
 
     // install error handler
-    ErrorHandler::get().disableMessage( QStringLiteral("qUncompress: Z_DATA_ERROR: Input data is corrupted file") );
     ErrorHandler::initialize();
 
     // try open input logbook
@@ -91,6 +90,8 @@ int main (int argc, char *argv[])
     Logbook logbook;
     logbook.setFile( input.expanded() );
     logbook.setUseCompression( useCompression );
+    logbook.setParallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
+    logbook.setCodec( FileFormat::codec( XmlOptions::get().raw( QStringLiteral("COMPRESSION_CODEC") ) ) );
     if( !logbook.read() )
     {
         Debug::Throw(0) << "copy-logbook - error reading logbook" << Qt::endl;
@@ -0,0 +1,213 @@
+/******************************************************************************
+*
+* Copyright (C) 2002 Hugo PEREIRA <mailto: hugo.pereira@free.fr>
+*
+* This is free software; you can redistribute it and/or modify it under the
+* terms of the GNU General Public License as published by the Free Software
+* Foundation; either version 2 of the License, or (at your option) any later
+* version.
+*
+* This software is distributed in the hope that it will be useful, but WITHOUT
+* Any WARRANTY; without even the implied warranty of MERCHANTABILITY or
+* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along with
+* this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*******************************************************************************/
+
+#include "Debug.h"
+#include "DefaultOptions.h"
+#include "LiveSync.h"
+#include "Logbook.h"
+#include "LogEntry.h"
+#include "XmlOptions.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QString>
+
+namespace
+{
+
+    namespace Local
+    {
+
+        //* time during which events are processed, once exchanges are expected to be complete (ms)
+        static const int SettleTime = 500;
+
+        //* process events for given time
+        void processEvents( int time = SettleTime )
+        {
+            QElapsedTimer timer;
+            timer.start();
+            while( timer.elapsed() < time )
+            { QCoreApplication::processEvents( QEventLoop::AllEvents, 10 ); }
+        }
+
+        //* entry with given title and text
+        LogEntry* entry( const QString& title, const QString& text )
+        {
+            auto out( new LogEntry );
+            out->setTitle( title );
+            out->setText( text );
+            return out;
+        }
+
+        //* entry matching given identifier, if any
+        LogEntry* find( const Logbook& logbook, quint64 id )
+        {
+            for( const auto& entry:logbook.entries() )
+            { if( entry->id() == id ) return entry; }
+            return nullptr;
+        }
+
+    }
+
+    //* logbook exchanging entries with a live sync peer, merging received ones the same way as the main window
+    class Replica
+    {
+
+        public:
+
+        //* constructor
+        explicit Replica( const File& file )
+        {
+            // the file is not read. It only identifies the logbook
+            logbook.setFile( file );
+            liveSync.setLogbook( &logbook );
+            QObject::connect( &liveSync, &LiveSync::entriesReceived, [this]( Logbook& remoteLogbook )
+                {
+                    ++received;
+                    const auto duplicates( logbook.synchronize( remoteLogbook ) );
+                    for( auto&& iter = duplicates.begin(); iter != duplicates.end(); ++iter )
+                    { delete iter.key(); }
+                } );
+        }
+
+        //* logbook
+        Logbook logbook;
+
+        //* live sync
+        LiveSync liveSync;
+
+        //* number of entry messages received
+        int received = 0;
+
+    };
+
+    //* failure count
+    int failures = 0;
+
+    //* check condition and report failure
+    void check( bool value, const QString& message )
+    {
+        Debug::Throw(0) << "live-sync-test - " << ( value ? "passed: ":"FAILED: " ) << message << Qt::endl;
+        if( !value ) ++failures;
+    }
+
+}
+
+//__________________________________________
+//! main function
+int main (int argc, char *argv[])
+{
+
+    // options
+    installDefaultOptions();
+    XmlOptions::get().set<int>(QStringLiteral("DEBUG_LEVEL"), 0 );
+    Debug::setLevel( 0 );
+
+    QCoreApplication application( argc, argv );
+
+    // both replicas live in this process, and use a dedicated channel
+    const QString channel( QStringLiteral("live-sync-test-%1").arg( QCoreApplication::applicationPid() ) );
+    const File file( QDir::temp().absoluteFilePath( QStringLiteral("live-sync-test-%1.xml").arg( QCoreApplication::applicationPid() ) ) );
+    const File otherFile( QDir::temp().absoluteFilePath( QStringLiteral("live-sync-test-%1-other.xml").arg( QCoreApplication::applicationPid() ) ) );
+
+    Replica left( file );
+    Replica right( otherFile );
+
+    // entries only held by one side
+    auto leftEntry( Local::entry( QStringLiteral("left"), QStringLiteral("left text") ) );
+    left.logbook.addEntry( leftEntry );
+
+    auto rightEntry( Local::entry( QStringLiteral("right"), QStringLiteral("right text") ) );
+    right.logbook.addEntry( rightEntry );
+
+    // entry held by both sides, with a common base
+    auto sharedEntry( Local::entry( QStringLiteral("shared"), QStringLiteral("shared text") ) );
+    sharedEntry->setBaseHash( sharedEntry->contentHash() );
+    auto sharedCopy( sharedEntry->copy() );
+    sharedCopy->setBaseHash( sharedEntry->contentHash() );
+    left.logbook.addEntry( sharedEntry );
+    right.logbook.addEntry( sharedCopy );
+
+    // concurrent changes to different groups of the shared entry, to be merged on both sides
+    const auto sharedId( sharedEntry->id() );
+    sharedEntry->setTitle( QStringLiteral("shared, left title") );
+    sharedCopy->setText( QStringLiteral("shared, right text") );
+
+    // connect with different logbooks. Nothing must be exchanged
+    left.liveSync.start( channel );
+    right.liveSync.start( channel );
+    Local::processEvents();
+
+    check( left.liveSync.isConnected() && right.liveSync.isConnected(), QStringLiteral("peers connected") );
+    check( !( left.liveSync.isSynchronized() || right.liveSync.isSynchronized() ), QStringLiteral("different logbooks not synchronized") );
+    check( left.received == 0 && right.received == 0, QStringLiteral("no entries exchanged between different logbooks") );
+    check( left.logbook.entries().size() == 2 && right.logbook.entries().size() == 2, QStringLiteral("logbooks unchanged") );
+
+    // open the same logbook on both sides. Manifests are sent again, and entries exchanged
+    right.logbook.setFile( file );
+    right.liveSync.setLogbook( &right.logbook );
+    Local::processEvents();
+
+    check( left.liveSync.isSynchronized() && right.liveSync.isSynchronized(), QStringLiteral("same logbooks synchronized") );
+    check( left.logbook.entries().size() == 3 && right.logbook.entries().size() == 3, QStringLiteral("missing entries exchanged") );
+    check( Local::find( left.logbook, rightEntry->id() ) && Local::find( right.logbook, leftEntry->id() ), QStringLiteral("entries received by identifier") );
+
+    /*
+    each side receives the other side version of the shared entry, and merges it into a result that differs from both.
+    The merged result is sent back once, and must be recognized as identical, rather than sent again
+    */
+    const auto leftMerged( Local::find( left.logbook, sharedId ) );
+    const auto rightMerged( Local::find( right.logbook, sharedId ) );
+    check( leftMerged && rightMerged, QStringLiteral("shared entry present on both sides") );
+    if( leftMerged && rightMerged )
+    {
+        check( leftMerged->title() == QStringLiteral("shared, left title") && leftMerged->text() == QStringLiteral("shared, right text"), QStringLiteral("shared entry merged on left side") );
+        check( rightMerged->title() == QStringLiteral("shared, left title") && rightMerged->text() == QStringLiteral("shared, right text"), QStringLiteral("shared entry merged on right side") );
+        check( leftMerged->contentHash() == rightMerged->contentHash(), QStringLiteral("merged entries identical") );
+    }
+
+    // explicit updates, as triggered by the main window, must not send anything once converged
+    const int leftReceived( left.received );
+    const int rightReceived( right.received );
+    left.liveSync.update();
+    right.liveSync.update();
+    Local::processEvents();
+    check( left.received == leftReceived && right.received == rightReceived, QStringLiteral("no entries sent once converged") );
+    check( left.received <= 2 && right.received <= 2, QStringLiteral("merged entries sent back at most once") );
+
+    // local modification is sent to peer
+    if( leftMerged )
+    {
+        leftMerged->setText( QStringLiteral("shared, left text") );
+        left.liveSync.update();
+        Local::processEvents();
+
+        const auto entry( Local::find( right.logbook, sharedId ) );
+        check( entry && entry->text() == QStringLiteral("shared, left text"), QStringLiteral("modified entry received") );
+        check( right.received == rightReceived + 1 && left.received == leftReceived, QStringLiteral("modified entry sent once") );
+    }
+
+    left.liveSync.stop();
+    right.liveSync.stop();
+
+    Debug::Throw(0) << "live-sync-test - " << failures << " failures" << Qt::endl;
+    return failures ? 1:0;
+
+}
@@ -36,7 +36,6 @@ int main (int argc, char *argv[])
 
     // error handler
     ErrorHandler::initialize();
-    ErrorHandler::get().disableMessage( QStringLiteral("qUncompress: Z_DATA_ERROR: Input data is corrupted file") );
 
     // options
     installDefaultOptions();
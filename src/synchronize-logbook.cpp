@@ -25,10 +25,78 @@
 #include "Util.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QString>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include <signal.h>
 #include <unistd.h>
 
+namespace
+{
+
+    //* synchronized logbook, with accumulated statistics
+    class Replica
+    {
+
+        public:
+
+        //* constructor
+        explicit Replica( const File& file ):
+            file( file ),
+            logbook( new Logbook )
+        {}
+
+        //* accumulate statistics from last synchronization
+        void addStatistics()
+        {
+            const auto& statistics( logbook->synchronizeStatistics() );
+            added += statistics.added;
+            replaced += statistics.replaced;
+            merged += statistics.merged;
+            skipped += statistics.skipped;
+
+            for( const auto& conflict:statistics.conflicts )
+            {
+                Debug::Throw(0)
+                    << "synchronize-logbook - conflict on entry " << conflict.title
+                    << " created " << conflict.creation.toString()
+                    << " in " << file
+                    << ( conflict.remoteKept ? ": remote version kept":": local version kept" )
+                    << ( conflict.hasBase ? "":" (no common version)" )
+                    << Qt::endl;
+            }
+
+            conflicts += statistics.conflicts.size();
+        }
+
+        //* file
+        File file;
+
+        //* logbook
+        std::unique_ptr<Logbook> logbook;
+
+        //* true if logbook is written
+        bool writable = false;
+
+        //*@name statistics
+        //@{
+        int added = 0;
+        int replaced = 0;
+        int merged = 0;
+        int skipped = 0;
+        int conflicts = 0;
+        qint64 synchronizeTime = 0;
+        qint64 writeTime = 0;
+        //@}
+
+    };
+
+}
+
 //_______________________________
 //! to handle keyboard interruptions
 void interrupt( int sig );
@@ -44,13 +112,14 @@ int main (int argc, char *argv[])
     // read argument
     if( argc < 3 )
     {
-        Debug::Throw(0) << "usage: synchronize-logbook <first logbook> <second logbook>" << Qt::endl;
+        Debug::Throw(0) << "usage: synchronize-logbook <logbook> <logbook> [<logbook> ...]" << Qt::endl;
         return 0;
     }
 
-    // load argument
-    File first( argv[1] );
-    File second( argv[2] );
+    // load arguments
+    std::vector<Replica> replicas;
+    for( int index = 1; index < argc; ++index )
+    { replicas.emplace_back( File( argv[index] ) ); }
 
     // load options
     QString user( Util::user( ) );
@@ -74,85 +143,110 @@ int main (int argc, char *argv[])
 
     // compression
     bool useCompression( XmlOptions::get().get<bool>( QStringLiteral("USE_COMPRESSION") ) );
+    bool parallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
+    const auto codec( FileFormat::codec( XmlOptions::get().raw( QStringLiteral("COMPRESSION_CODEC") ) ) );
 
     // the core application is needed to have locale, fonts, etc. set properly, notably for QSting
     // not having it might result in lost accents and special characters.
     QCoreApplication application( argc, argv );
 
     // install error handler
-    ErrorHandler::get().disableMessage( QStringLiteral("qUncompress: Z_DATA_ERROR: Input data is corrupted file") );
     ErrorHandler::initialize();
 
-    // try open first Logbook
-    Debug::Throw(0) << "synchronize-logbook - reading first logbook from: " << first << Qt::endl;
-    Logbook firstLogbook;
-    firstLogbook.setFile( first.expanded() );
-    firstLogbook.setUseCompression( useCompression );
-    if( !firstLogbook.read() )
+    // configure logbooks
+    /* children are only read when synchronization needs them */
+    QList<Logbook*> logbooks;
+    for( auto&& replica:replicas )
     {
-        Debug::Throw(0) << "synchronize-logbook - error reading first logbook" << Qt::endl;
-        return 0;
+        auto&& logbook( replica.logbook );
+        logbook->setFile( replica.file.expanded() );
+        logbook->setUseCompression( useCompression );
+        logbook->setParallelWrite( parallelWrite );
+        logbook->setCodec( codec );
+        logbook->setSharding( Logbook::Sharding::fromOptions() );
+        logbook->setManifestOnly( true );
+        logbooks.append( logbook.get() );
     }
 
-    // debug
-    Debug::Throw(0) << "synchronize-logbook - number of files in first logbook: " << firstLogbook.children().size() << Qt::endl;
-    Debug::Throw(0) << "synchronize-logbook - number of entries in first logbook: " << firstLogbook.entries().size() << Qt::endl;
+    // read all logbooks at once
+    QElapsedTimer timer;
+    timer.start();
+    const auto failed( Logbook::readAll( logbooks ) );
+    for( const auto& logbook:failed )
+    { Debug::Throw(0) << "synchronize-logbook - error reading logbook " << logbook->file() << Qt::endl; }
 
-    // try open second logbook
-    Debug::Throw(0) << "synchronize-logbook - reading second logbook from: " << second << Qt::endl;
-    Logbook secondLogbook;
-    secondLogbook.setFile( second.expanded() );
-    secondLogbook.setUseCompression( useCompression );
-    if( !secondLogbook.read() )
+    if( !failed.empty() ) return 0;
+    Debug::Throw(0) << "synchronize-logbook - read " << replicas.size() << " logbooks in " << timer.elapsed() << "ms" << Qt::endl;
+
+    for( auto&& replica:replicas )
     {
-        Debug::Throw(0) << "synchronize-logbook - error reading second logbook" << Qt::endl;
-        return 0;
+        replica.writable = !replica.logbook->isReadOnly();
+        Debug::Throw(0)
+            << "synchronize-logbook - " << replica.file
+            << " files: " << replica.logbook->children().size()
+            << " entries: " << replica.logbook->xmlEntries()
+            << ( replica.writable ? "":" (read-only)" )
+            << Qt::endl;
     }
 
-    // debug
-    Debug::Throw(0) << "synchronize-logbook - number of files in second logbook: " << secondLogbook.children().size() << Qt::endl;
-    Debug::Throw(0) << "synchronize-logbook - number of entries in second logbook: " << secondLogbook.entries().size() << Qt::endl;
-
-    // check whether first logbook is read-only
-    if( firstLogbook.isReadOnly() )
+    /*
+    the first writable logbook is used to compute the merged state from all others.
+    All other writable logbooks are then updated from it, and each logbook is written once.
+    Since synchronization only modifies the destination, merging one logbook into several ones is safe
+    */
+    auto hub( std::find_if( replicas.begin(), replicas.end(), []( const Replica& replica ) { return replica.writable; } ) );
+    if( hub == replicas.end() )
     {
-
-        Debug::Throw(0) << "synchronize-logbook - first logbook is read-only. It will not be synchronized to the second logbook." << Qt::endl;
-
-    } else {
-
-        Debug::Throw(0) << "synchronize-logbook - updating first logbook from second" << Qt::endl;
-        const int nDuplicated( firstLogbook.synchronize( secondLogbook ).size() );
-        Debug::Throw(0) << "synchronize-logbook - number of duplicated entries: " << nDuplicated << Qt::endl;
-
-        if( !firstLogbook.write() )
-        {
-            Debug::Throw(0) << "synchronize-logbook - error writing first logbook" << Qt::endl;
-            return 0;
-        }
-
+        Debug::Throw(0) << "synchronize-logbook - all logbooks are read-only. Nothing to synchronize." << Qt::endl;
+        return 0;
     }
 
-    // check whether second logbook is read-only
-    if( secondLogbook.isReadOnly() )
+    Debug::Throw(0) << "synchronize-logbook - merging all logbooks into " << hub->file << Qt::endl;
+    for( auto&& replica:replicas )
     {
+        if( &replica == &*hub ) continue;
+        timer.restart();
+        hub->logbook->synchronize( *replica.logbook );
+        hub->synchronizeTime += timer.elapsed();
+        hub->addStatistics();
+    }
 
-        Debug::Throw(0) << "synchronize-logbook - second logbook is read-only. It will not be synchronized to the first logbook." << Qt::endl;
-
-    } else {
-
-        Debug::Throw(0) << "synchronize-logbook - updating second logbook from first" << Qt::endl;
-        const int nDuplicated( secondLogbook.synchronize( firstLogbook ).size() );
+    for( auto&& replica:replicas )
+    {
+        if( &replica == &*hub || !replica.writable ) continue;
+        timer.restart();
+        replica.logbook->synchronize( *hub->logbook );
+        replica.synchronizeTime += timer.elapsed();
+        replica.addStatistics();
+    }
 
-        Debug::Throw(0) << "synchronize-logbook - number of duplicated entries: " << nDuplicated << Qt::endl;
+    // write
+    for( auto&& replica:replicas )
+    {
+        if( !( replica.writable && replica.logbook->modified() ) ) continue;
+        timer.restart();
+        if( !replica.logbook->write() )
+        { Debug::Throw(0) << "synchronize-logbook - error writing logbook " << replica.file << Qt::endl; }
 
-        if( !secondLogbook.write() )
-        {
-            Debug::Throw(0) << "error writting to second logbook" << Qt::endl;
-            return 0;
-        }
+        replica.writeTime = timer.elapsed();
+    }
 
+    // statistics
+    for( const auto& replica:replicas )
+    {
+        Debug::Throw(0)
+            << "synchronize-logbook - " << replica.file
+            << " added: " << replica.added
+            << " replaced: " << replica.replaced
+            << " merged: " << replica.merged
+            << " skipped: " << replica.skipped
+            << " conflicts: " << replica.conflicts
+            << " synchronize: " << replica.synchronizeTime << "ms"
+            << " write: " << replica.writeTime << "ms"
+            << " (" << replica.logbook->writeStatistics().files << " files)"
+            << Qt::endl;
     }
+
     return 0;
 
 }
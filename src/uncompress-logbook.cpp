@@ -79,13 +79,13 @@ int main (int argc, char *argv[])
     QCoreApplication application( argc, argv );
 
     // install error handler
-    ErrorHandler::get().disableMessage( QStringLiteral("qUncompress: Z_DATA_ERROR: Input data is corrupted file") );
     ErrorHandler::initialize();
 
     // try open input logbook
     Debug::Throw(0) << "uncompress-logbook - reading from: " << input << Qt::endl;
     Logbook logbook;
     logbook.setFile( input.expanded() );
+    logbook.setParallelWrite( XmlOptions::get().get<bool>( QStringLiteral("PARALLEL_WRITE") ) );
     if( !logbook.read() )
     {
         Debug::Throw(0) << "uncompress-logbook - error reading logbook" << Qt::endl;